@@ -1,5 +1,4 @@
 #include <vector>
-#include <unordered_map>
 #include <random>
 #include <fstream>
 #include <sstream>
@@ -7,154 +6,817 @@
 #include <algorithm>
 #include <limits>
 #include <iostream>
+#include <numeric>
+#include <charconv>
+#include <unordered_map>
+#include <cstdint>
+#if defined(__x86_64__) || defined(__i386__)
+#define ANT_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+#include "../headers/loader.h"
+#include "../headers/random.h"
+#include "../headers/thread_pool.h"
+
+// Локальный поиск после построения тура
+enum class LocalSearch
+{
+  None,
+  TwoOpt,
+  OrOpt,
+  TwoOptOrOpt
+};
 
-class AntColony
+// Какие туры улучшать: каждый или только лучший на итерации
+enum class SearchScope
 {
-private:
-  int n_ants;
-  int n_iterations;
-  double decay;
-  double alpha;
-  double beta;
-  std::random_device rd;
-  std::mt19937 gen;
+  EachTour,
+  IterationBest
+};
+
+// Неориентированный граф дорог в CSR. Полная матрица расстояний не строится:
+// при 100k городов это 80 ГБ, расстояния ищутся Дейкстрой по рёбрам.
+// Поэтому и матрица кратчайших путей AllPairs (all_pairs.h) колонии не нужна:
+// кандидаты и запасные ходы и так получают точные расстояния по дорогам
+class Roads
+{
+  std::vector<int> offsets; // рёбра города v - [offsets[v], offsets[v + 1])
+  std::vector<int> targets;
+  std::vector<double> weights;
 
 public:
-  AntColony(int ants, int iterations, double decay_rate, double a = 1.0, double b = 2.0)
-      : n_ants(ants), n_iterations(iterations), decay(decay_rate), alpha(a), beta(b), gen(rd()) {}
+  // Буферы поиска с метками поколения, живут между поисками: один на поток
+  struct Search
+  {
+    std::vector<double> distance;
+    std::vector<uint32_t> stamp;
+    uint32_t generation = 0;
+    std::vector<std::pair<double, int>> heap;
+  };
 
-  std::vector<std::vector<double>> buildGraph(const std::string &filename)
+  explicit Roads(const EdgeList &list)
   {
-    std::unordered_map<int, std::unordered_map<int, int>> edges;
-    int max_vertex = 0;
+    int max_vertex = -1;
+    std::vector<std::pair<int, int>> ends;
+    ends.reserve(list.getEdges().size());
+    for (const EdgeRecord &edge : list.getEdges())
+    {
+      int v1 = 0, v2 = 0;
+      std::from_chars(edge.departure.data(), edge.departure.data() + edge.departure.size(), v1);
+      std::from_chars(edge.target.data(), edge.target.data() + edge.target.size(), v2);
+      ends.push_back({v1, v2});
+      max_vertex = std::max({max_vertex, v1, v2});
+    }
 
-    std::ifstream file(filename);
-    int v1, v2, weight;
+    offsets.assign(max_vertex + 2, 0);
+    for (auto [v1, v2] : ends)
+    {
+      offsets[v1 + 1]++;
+      offsets[v2 + 1]++;
+    }
+    for (size_t v = 1; v < offsets.size(); v++)
+    {
+      offsets[v] += offsets[v - 1];
+    }
 
-    while (file >> v1 >> v2 >> weight)
+    targets.resize(offsets.back());
+    weights.resize(offsets.back());
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t e = 0; e < ends.size(); e++)
     {
-      edges[v1][v2] = weight;
-      edges[v2][v1] = weight;
-      max_vertex = std::max({max_vertex, v1, v2});
+      auto [v1, v2] = ends[e];
+      double weight = list.getEdges()[e].weight;
+      targets[fill[v1]] = v2;
+      weights[fill[v1]++] = weight;
+      targets[fill[v2]] = v1;
+      weights[fill[v2]++] = weight;
     }
+  }
+
+  int size() const { return int(offsets.size()) - 1; }
 
-    int n = max_vertex + 1;
-    std::vector<std::vector<double>> distances(n, std::vector<double>(n, std::numeric_limits<double>::infinity()));
+  // Дейкстра из source: города, кроме самого source, приходят в visit(city, distance)
+  // по возрастанию расстояния, пока visit не вернёт true. Возвращает, была ли остановка
+  template <class Visit>
+  bool search(int source, Search &s, Visit visit) const
+  {
+    if (s.stamp.size() != size_t(size()))
+    {
+      s.distance.assign(size(), 0);
+      s.stamp.assign(size(), 0);
+      s.generation = 0;
+    }
+    if (++s.generation == 0)
+    {
+      std::fill(s.stamp.begin(), s.stamp.end(), 0);
+      s.generation = 1;
+    }
 
-    double max_weight = 0;
-    for (const auto &[vertex1, connections] : edges)
+    auto greater = std::greater<std::pair<double, int>>();
+    auto relax = [&](int city, double distance)
     {
-      for (const auto &[vertex2, weight] : connections)
+      if (s.stamp[city] != s.generation || distance < s.distance[city])
       {
-        distances[vertex1][vertex2] = weight;
-        max_weight = std::max(max_weight, (double)weight);
+        s.stamp[city] = s.generation;
+        s.distance[city] = distance;
+        s.heap.push_back({distance, city});
+        std::push_heap(s.heap.begin(), s.heap.end(), greater);
       }
-    }
+    };
 
-    max_weight *= 10;
-    for (int i = 0; i < n; i++)
+    s.heap.clear();
+    relax(source, 0);
+    while (!s.heap.empty())
     {
-      for (int j = 0; j < n; j++)
+      std::pop_heap(s.heap.begin(), s.heap.end(), greater);
+      auto [distance, city] = s.heap.back();
+      s.heap.pop_back();
+      if (distance > s.distance[city])
       {
-        if (std::isinf(distances[i][j]))
-        {
-          distances[i][j] = max_weight;
-        }
+        continue;
+      }
+      if (city != source && visit(city, distance))
+      {
+        return true;
+      }
+      for (int e = offsets[city]; e < offsets[city + 1]; e++)
+      {
+        relax(targets[e], distance + weights[e]);
       }
     }
+    return false;
+  }
+};
 
-    return distances;
+// Известные расстояния тура вне списков кандидатов: запасные ходы и
+// замыкающее ребро. Ключ - пара городов, меньший в старших битах
+using KnownEdges = std::unordered_map<uint64_t, double>;
+
+inline uint64_t edgeKey(int a, int b)
+{
+  return uint64_t(std::min(a, b)) << 32 | uint32_t(std::max(a, b));
+}
+
+// Списки кандидатов: k ближайших по дорогам городов каждого города по
+// возрастанию расстояния, cities[city * k + j]. Если город видит меньше k
+// других, список добивается им самим с бесконечным расстоянием
+struct Candidates
+{
+  int k = 0;
+  std::vector<int> cities;
+  std::vector<double> distances;
+
+  // Расстояние a - b, если ребро есть в списке a, в списке b или в known,
+  // иначе бесконечность: такие рёбра ходы не добавляют
+  double find(int a, int b, const KnownEdges &known) const
+  {
+    for (int j = 0; j < k; j++)
+    {
+      if (cities[size_t(a) * k + j] == b)
+      {
+        return distances[size_t(a) * k + j];
+      }
+    }
+    for (int j = 0; j < k; j++)
+    {
+      if (cities[size_t(b) * k + j] == a)
+      {
+        return distances[size_t(b) * k + j];
+      }
+    }
+    auto it = known.find(edgeKey(a, b));
+    return it != known.end() ? it->second : std::numeric_limits<double>::infinity();
   }
 
-  double calculatePathLength(const std::vector<int> &path, const std::vector<std::vector<double>> &distances)
+  double tourLength(const std::vector<int> &path, const KnownEdges &known) const
   {
     double length = 0;
     for (size_t i = 0; i < path.size(); i++)
     {
-      length += distances[path[i]][path[(i + 1) % path.size()]];
+      length += find(path[i], path[(i + 1) % path.size()], known);
     }
     return length;
   }
+};
+
+// Тур муравья: города, вероятности шагов и расстояния рёбер вне кандидатов
+struct Tour
+{
+  std::vector<int> path;
+  std::vector<double> probabilities;
+  KnownEdges known;
+};
+
+// 2-opt и Or-opt по спискам кандидатов с битами "не смотреть": город
+// просматривается снова, только если рядом с ним поменялось ребро.
+// Расстояния берутся только с рёбер-кандидатов и известных рёбер тура, ход с
+// неизвестным ребром пропускается. Один объект на поток, буферы живут между турами
+class TourImprover
+{
+  const Candidates &candidates;
+  const KnownEdges *known = nullptr;
+  int k;
+  LocalSearch method;
+
+  std::vector<int> tour;
+  std::vector<int> position; // индекс города в tour
+  std::vector<int> active;   // очередь городов без бита "не смотреть"
+  std::vector<char> queued;
+
+  static constexpr double epsilon = 1e-9;
+
+  int n() const { return int(tour.size()); }
+  double d(int a, int b) const { return candidates.find(a, b, *known); }
+  int next(int city) const { return tour[(position[city] + 1) % n()]; }
+  int prev(int city) const { return tour[(position[city] + n() - 1) % n()]; }
+
+  void activate(int city)
+  {
+    if (!queued[city])
+    {
+      queued[city] = 1;
+      active.push_back(city);
+    }
+  }
 
-  std::vector<double> calculateProbabilities(int current, const std::vector<bool> &visited,
-                                              const std::vector<std::vector<double>> &distances,
-                                              const std::vector<std::vector<double>> &pheromone)
+  // Разворот отрезка тура от позиции i до j вперёд по кругу. Разворачивается
+  // более короткая из двух частей: как цикл тур получается тот же
+  void reverse(int i, int j)
   {
-    std::vector<double> probabilities;
-    std::vector<int> unvisited;
+    int length = (j - i + n()) % n() + 1;
+    if (2 * length > n())
+    {
+      std::swap(i, j);
+      i = (i + 1) % n();
+      j = (j + n() - 1) % n();
+      length = n() - length;
+    }
+
+    for (int step = 0; step < length / 2; step++)
+    {
+      std::swap(tour[i], tour[j]);
+      position[tour[i]] = i;
+      position[tour[j]] = j;
+      i = (i + 1) % n();
+      j = (j + n() - 1) % n();
+    }
+  }
 
-    for (size_t i = 0; i < visited.size(); i++)
+  // Рёбра (a, succ a) и (c, succ c) или (pred a, a) и (pred c, c) заменяются
+  // на (a, c) и (b, d), если это короче
+  bool twoOpt(int a)
+  {
+    for (int forward = 1; forward >= 0; forward--)
     {
-      if (!visited[i])
+      int b = forward ? next(a) : prev(a);
+      double removed = d(a, b);
+
+      for (int j = 0; j < k; j++)
       {
-        unvisited.push_back(i);
+        int c = candidates.cities[size_t(a) * k + j];
+        double added = candidates.distances[size_t(a) * k + j];
+        // кандидаты отсортированы, дальше только длиннее
+        if (added >= removed - epsilon)
+        {
+          break;
+        }
+
+        int e = forward ? next(c) : prev(c);
+        if (c == b || e == a)
+        {
+          continue;
+        }
+
+        if (added + d(b, e) < removed + d(c, e) - epsilon)
+        {
+          if (forward)
+          {
+            reverse(position[b], position[c]);
+          }
+          else
+          {
+            reverse(position[a], position[e]);
+          }
+
+          for (int city : {a, b, c, e})
+          {
+            activate(city);
+          }
+          return true;
+        }
       }
     }
+    return false;
+  }
 
-    for (int city : unvisited)
+  // Отрезок из 1-3 городов, начинающийся в first, переносится между
+  // кандидатом одного из его концов и соседом кандидата
+  bool orOpt(int first)
+  {
+    for (int length = 1; length <= 3 && length + 3 < n(); length++)
     {
-      double p = pow(pheromone[current][city], alpha) * pow(1.0 / distances[current][city], beta);
-      probabilities.push_back(p);
+      int last = tour[(position[first] + length - 1) % n()];
+      int before = prev(first), after = next(last);
+      double gain = d(before, first) + d(last, after) - d(before, after);
+      if (gain <= epsilon)
+      {
+        continue;
+      }
+
+      auto inside = [&](int city) { return (position[city] - position[first] + n()) % n() < length; };
+
+      for (int end : {first, last})
+      {
+        int other = end == first ? last : first;
+        for (int j = 0; j < k; j++)
+        {
+          int c = candidates.cities[size_t(end) * k + j];
+          double added = candidates.distances[size_t(end) * k + j];
+          if (added >= gain - epsilon)
+          {
+            break;
+          }
+          if (inside(c))
+          {
+            continue;
+          }
+
+          for (int e : {next(c), prev(c)})
+          {
+            if (inside(e) || (c == before && e == after) || (c == after && e == before))
+            {
+              continue;
+            }
+            if (added + d(other, e) - d(c, e) >= gain - epsilon)
+            {
+              continue;
+            }
+
+            move(first, last, c, e, end);
+            for (int city : {before, after, first, last, c, e})
+            {
+              activate(city);
+            }
+            return true;
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+  // 2-opt: рёбра {a, b} и {c, d} заменяются на {a, c} и {b, d}. Направление
+  // обхода после разворотов может смениться, поэтому рёбра заданы городами
+  void exchange(int a, int b, int c, int d)
+  {
+    if (b == c || a == d)
+    {
+      return;
+    }
+    if (next(a) != b)
+    {
+      std::swap(a, b);
+      std::swap(c, d);
     }
+    reverse(position[b], position[c]);
+  }
 
-    double total = std::accumulate(probabilities.begin(), probabilities.end(), 0.0);
-    if (total == 0)
+  // Отрезок first..last встаёт между c и e так, что end рядом с c. Перенос
+  // складывается из двух-трёх 2-opt, каждый разворачивает более короткую часть тура
+  void move(int first, int last, int c, int e, int end)
+  {
+    int before = prev(first), after = next(last);
+    // x - тот из c и e, что ближе к after по ходу тура
+    int x = next(c) == e ? c : e;
+    int y = x == c ? e : c;
+
+    exchange(before, first, x, y); // before - x..after - last..first - y
+    exchange(before, x, after, last); // before - after..x - last..first - y
+    if ((x == c) != (end == last))
     {
-      return std::vector<double>(unvisited.size(), 1.0 / unvisited.size());
+      exchange(x, last, first, y);
     }
+  }
+
+public:
+  TourImprover(const Candidates &c, LocalSearch m) : candidates(c), k(c.k), method(m) {}
 
-    for (double &p : probabilities)
+  // Рёбра тура известны до хода - известны и после: ход добавляет только
+  // рёбра с конечным расстоянием
+  void improve(std::vector<int> &path, const KnownEdges &edges)
+  {
+    if (method == LocalSearch::None || path.size() < 5)
     {
-      p /= total;
+      return;
     }
 
-    return probabilities;
+    known = &edges;
+    tour = path;
+    position.resize(tour.size());
+    queued.assign(tour.size(), 0);
+    active.clear();
+    for (int i = 0; i < n(); i++)
+    {
+      position[tour[i]] = i;
+    }
+    for (int i = n() - 1; i >= 0; i--)
+    {
+      activate(tour[i]);
+    }
+
+    bool two_opt = method == LocalSearch::TwoOpt || method == LocalSearch::TwoOptOrOpt;
+    bool or_opt = method == LocalSearch::OrOpt || method == LocalSearch::TwoOptOrOpt;
+
+    while (!active.empty())
+    {
+      int city = active.back();
+      active.pop_back();
+      queued[city] = 0;
+
+      // Пока ход из города находится, город остаётся в работе
+      if ((two_opt && twoOpt(city)) || (or_opt && orOpt(city)))
+      {
+        activate(city);
+      }
+    }
+
+    path = tour;
   }
+};
 
-  std::pair<std::vector<int>, std::vector<double>> constructPath(
-      const std::vector<std::vector<double>> &distances,
-      const std::vector<std::vector<double>> &pheromone)
+// Векторные ядра: AVX2-версии собираются атрибутом target и выбираются
+// при запуске, так что флаг -mavx2 не нужен
+
+static void multiplyScalar(const double *a, const double *b, double *out, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
   {
-    int n_cities = distances.size();
-    std::vector<bool> visited(n_cities, false);
-    std::vector<int> path;
-    std::vector<double> path_probabilities;
+    out[i] = a[i] * b[i];
+  }
+}
+
+// Веса непосещённых кандидатов, посещённые (position < 0) обнуляются
+static double candidateWeightsScalar(const double *row, const int *near, const int *position, int k, double *weights)
+{
+  double total = 0;
+  for (int j = 0; j < k; j++)
+  {
+    weights[j] = position[near[j]] >= 0 ? row[j] : 0.0;
+    total += weights[j];
+  }
+  return total;
+}
+
+#ifdef ANT_AVX2_DISPATCH
+__attribute__((target("avx2"))) static void multiplyAvx2(const double *a, const double *b, double *out, size_t n)
+{
+  size_t i = 0;
+  for (; i + 4 <= n; i += 4)
+  {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+  }
+  multiplyScalar(a + i, b + i, out + i, n - i);
+}
+
+__attribute__((target("avx2"))) static double candidateWeightsAvx2(const double *row, const int *near, const int *position, int k, double *weights)
+{
+  __m256d sum = _mm256_setzero_pd();
+  int j = 0;
+  for (; j + 4 <= k; j += 4)
+  {
+    __m128i cities = _mm_loadu_si128(reinterpret_cast<const __m128i *>(near + j));
+    __m128i index = _mm_mask_i32gather_epi32(_mm_setzero_si128(), position, cities, _mm_set1_epi32(-1), 4);
+    __m128i open = _mm_cmpgt_epi32(index, _mm_set1_epi32(-1));
+    __m256d mask = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(open));
+    __m256d w = _mm256_and_pd(_mm256_loadu_pd(row + j), mask);
+    _mm256_storeu_pd(weights + j, w);
+    sum = _mm256_add_pd(sum, w);
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, sum);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + candidateWeightsScalar(row + j, near + j, position, k - j, weights + j);
+}
 
-    std::uniform_int_distribution<> dis(0, n_cities - 1);
-    int start = dis(gen);
-    path.push_back(start);
-    visited[start] = true;
+static bool hasAvx2()
+{
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+#endif
+
+static void multiply(const double *a, const double *b, double *out, size_t n)
+{
+#ifdef ANT_AVX2_DISPATCH
+  if (hasAvx2())
+  {
+    multiplyAvx2(a, b, out, n);
+    return;
+  }
+#endif
+  multiplyScalar(a, b, out, n);
+}
+
+static double candidateWeights(const double *row, const int *near, const int *position, int k, double *weights)
+{
+#ifdef ANT_AVX2_DISPATCH
+  if (hasAvx2())
+  {
+    return candidateWeightsAvx2(row, near, position, k, weights);
+  }
+#endif
+  return candidateWeightsScalar(row, near, position, k, weights);
+}
 
-    while (path.size() < n_cities)
+class AntColony
+{
+private:
+  int n_ants;
+  int n_iterations;
+  double decay;
+  double alpha;
+  double beta;
+  int n_candidates;
+  LocalSearch local_search = LocalSearch::None;
+  SearchScope search_scope = SearchScope::EachTour;
+  ThreadPool pool;
+  std::random_device rd;
+  Xoshiro256 gen;
+
+  // Рабочие буферы шага, живут между муравьями
+  std::vector<int> unvisited;
+  std::vector<int> position; // индекс города в unvisited или -1, если он посещён
+  std::vector<double> weights;
+  Roads::Search search;
+
+  // Расстояние между городами разных компонент связности: в 10 раз больше
+  // самого длинного ребра-кандидата
+  double penalty = 0;
+
+  // Ближайший город, для которого open(city) - true, и расстояние до него
+  // или {-1, penalty}, если такого не достать
+  template <class Open>
+  std::pair<int, double> nearest(const Roads &roads, int source, Open open)
+  {
+    std::pair<int, double> found{-1, penalty};
+    roads.search(source, search, [&](int city, double distance)
+    {
+      if (!open(city))
+      {
+        return false;
+      }
+      found = {city, distance};
+      return true;
+    });
+    return found;
+  }
+
+public:
+  AntColony(int ants, int iterations, double decay_rate, double a = 1.0, double b = 2.0, int candidates = 20)
+      : n_ants(ants), n_iterations(iterations), decay(decay_rate), alpha(a), beta(b), n_candidates(candidates), gen(rd()) {}
+
+  void setLocalSearch(LocalSearch method, SearchScope scope = SearchScope::EachTour)
+  {
+    local_search = method;
+    search_scope = scope;
+  }
+
+  Roads buildGraph(const std::string &filename)
+  {
+    EdgeList list(filename);
+    return Roads(list);
+  }
+
+  // Кандидаты - первые k городов, до которых дошла ограниченная Дейкстра:
+  // O(n * k log k) вместо сортировки строк полной матрицы. Один раз за запуск
+  Candidates buildCandidates(const Roads &roads, int k)
+  {
+    int n_cities = roads.size();
+    Candidates candidates;
+    candidates.k = k;
+    candidates.cities.resize(size_t(n_cities) * k);
+    candidates.distances.assign(size_t(n_cities) * k, std::numeric_limits<double>::infinity());
+
+    std::vector<Roads::Search> searches(pool.size());
+    pool.parallelFor(n_cities, [&](size_t city, size_t slot)
+    {
+      int *near = &candidates.cities[city * k];
+      double *distance = &candidates.distances[city * k];
+      std::fill(near, near + k, int(city));
+
+      int found = 0;
+      roads.search(int(city), searches[slot], [&](int other, double d)
+      {
+        near[found] = other;
+        distance[found] = d;
+        return ++found == k;
+      });
+    });
+
+    return candidates;
+  }
+
+  // Номер ребра a -> b в списках кандидатов или -1, если b не кандидат для a
+  static long candidateEdge(const Candidates &candidates, int a, int b)
+  {
+    int k = candidates.k;
+    for (int j = 0; j < k; j++)
+    {
+      if (candidates.cities[size_t(a) * k + j] == b && b != a)
+      {
+        return long(a) * k + j;
+      }
+    }
+    return -1;
+  }
+
+  // eta^beta на рёбрах-кандидатах, один раз за запуск; у добивки 0
+  std::vector<double> calculateHeuristic(const Candidates &candidates)
+  {
+    std::vector<double> heuristic(candidates.cities.size());
+    for (size_t i = 0; i < heuristic.size(); i++)
+    {
+      heuristic[i] = pow(1.0 / candidates.distances[i], beta);
+    }
+    return heuristic;
+  }
+
+  // choice = tau^alpha * eta^beta на рёбрах-кандидатах, раз за итерацию: внутри
+  // итерации феромоны не меняются.
+  // При alpha != 1 степень считается скалярно, произведение - общим ядром
+  void calculateChoice(const std::vector<double> &pheromone, const std::vector<double> &heuristic, std::vector<double> &choice)
+  {
+    const double *tau = pheromone.data();
+    if (alpha != 1.0)
+    {
+      for (size_t i = 0; i < choice.size(); i++)
+      {
+        choice[i] = pow(pheromone[i], alpha);
+      }
+      tau = choice.data();
+    }
+    multiply(tau, heuristic.data(), choice.data(), choice.size());
+  }
+
+  // Шаг - O(k): город выбирается рулеткой среди непосещённых кандидатов.
+  // Только если все кандидаты посещены, Дейкстра ищет ближайший непосещённый
+  // город - феромон вне списков у всех рёбер одинаковый. Расстояния таких
+  // рёбер и замыкающего ребра запоминаются в туре
+  Tour constructPath(const Roads &roads, const Candidates &candidates, const std::vector<double> &choice)
+  {
+    int n_cities = roads.size();
+    int k = candidates.k;
+    Tour tour;
+    std::vector<int> &path = tour.path;
+    path.reserve(n_cities);
+    tour.probabilities.reserve(n_cities);
+
+    unvisited.resize(n_cities);
+    position.resize(n_cities);
+    for (int i = 0; i < n_cities; i++)
+    {
+      unvisited[i] = i;
+      position[i] = i;
+    }
+    weights.resize(k);
+
+    // Удаление обменом с последним, O(1)
+    auto visit = [&](int city)
+    {
+      int index = position[city];
+      int last = unvisited.back();
+      unvisited[index] = last;
+      position[last] = index;
+      unvisited.pop_back();
+      position[city] = -1;
+      path.push_back(city);
+    };
+
+    visit(int(gen() % uint64_t(n_cities)));
+
+    while (!unvisited.empty())
     {
       int current = path.back();
-      auto probabilities = calculateProbabilities(current, visited, distances, pheromone);
+      const int *near = &candidates.cities[size_t(current) * k];
+      const double *row = &choice[size_t(current) * k];
+
+      double total = candidateWeights(row, near, position.data(), k, weights.data());
 
-      std::vector<int> unvisited;
-      for (int i = 0; i < n_cities; i++)
+      int next_city = -1;
+      double probability = 1.0;
+      if (total > 0)
       {
-        if (!visited[i])
+        double target = gen.uniform() * total;
+        double cumulative = 0;
+        int chosen = -1;
+        for (int j = 0; j < k; j++)
         {
-          unvisited.push_back(i);
+          cumulative += weights[j];
+          if (weights[j] > 0)
+          {
+            chosen = j; // последний подходящий - на случай ошибки округления
+            if (target < cumulative)
+            {
+              break;
+            }
+          }
         }
+        next_city = near[chosen];
+        probability = weights[chosen] / total;
       }
+      else
+      {
+        auto [city, distance] = nearest(roads, current, [&](int other) { return position[other] >= 0; });
+        next_city = city >= 0 ? city : unvisited.front();
+        tour.known[edgeKey(current, next_city)] = distance;
+      }
+
+      tour.probabilities.push_back(probability);
+      visit(next_city);
+    }
+
+    int first = path.front(), last = path.back();
+    if (first != last && candidates.find(last, first, tour.known) == std::numeric_limits<double>::infinity())
+    {
+      tour.known[edgeKey(last, first)] = nearest(roads, last, [&](int city) { return city == first; }).second;
+    }
+
+    return tour;
+  }
+
+  // Вероятности шагов готового тура при текущих весах choice - так же, как их
+  // считает constructPath. Нужны для туров после локального поиска: его ходы
+  // муравей мог бы и не сделать, тогда вероятность шага 0
+  std::vector<double> replayProbabilities(const Tour &tour, const Roads &roads, const Candidates &candidates,
+                                          const std::vector<double> &choice)
+  {
+    const std::vector<int> &path = tour.path;
+    int k = candidates.k;
+    std::vector<double> probabilities;
+    std::vector<char> visited(path.size(), 0);
+    visited[path.front()] = 1;
 
-      std::discrete_distribution<> dist(probabilities.begin(), probabilities.end());
-      int next_idx = dist(gen);
-      int next_city = unvisited[next_idx];
+    for (size_t i = 0; i + 1 < path.size(); i++)
+    {
+      int current = path[i], next = path[i + 1];
+      double total = 0, chosen = 0;
+      for (int j = 0; j < k; j++)
+      {
+        int city = candidates.cities[size_t(current) * k + j];
+        if (!visited[city])
+        {
+          total += choice[size_t(current) * k + j];
+          if (city == next)
+          {
+            chosen = choice[size_t(current) * k + j];
+          }
+        }
+      }
 
-      path_probabilities.push_back(probabilities[next_idx]);
-      path.push_back(next_city);
-      visited[next_city] = true;
+      if (total > 0)
+      {
+        probabilities.push_back(chosen / total);
+      }
+      else
+      {
+        // Запасной ход - ближайший непосещённый город
+        auto [city, distance] = nearest(roads, current, [&](int other) { return !visited[other]; });
+        bool nearest_city = city < 0 || distance == candidates.find(current, next, tour.known);
+        probabilities.push_back(nearest_city ? 1.0 : 0.0);
+      }
+      visited[next] = 1;
     }
 
-    return {path, path_probabilities};
+    return probabilities;
   }
 
-  void solve(const std::vector<std::vector<double>> &distances)
+  void solve(const Roads &roads)
   {
-    int n_cities = distances.size();
-    std::vector<std::vector<double>> pheromone(n_cities, std::vector<double>(n_cities, 1.0 / n_cities));
+    int n_cities = roads.size();
+    int k = std::max(1, std::min(n_candidates, n_cities - 1));
+    if (n_cities < 2)
+    {
+      return;
+    }
+
+    // Феромон хранится только на рёбрах-кандидатах, n * k вместо n * n;
+    // у остальных рёбер он постоянный base_pheromone
+    Candidates candidates = buildCandidates(roads, k);
+    double longest = 0;
+    for (double distance : candidates.distances)
+    {
+      if (distance != std::numeric_limits<double>::infinity())
+      {
+        longest = std::max(longest, distance);
+      }
+    }
+    penalty = longest * 10;
+
+    double base_pheromone = 1.0 / n_cities;
+    std::vector<double> pheromone(candidates.cities.size(), base_pheromone);
+    std::vector<double> heuristic = calculateHeuristic(candidates);
+    std::vector<double> choice(pheromone.size());
+    std::vector<TourImprover> improvers(pool.size(), TourImprover(candidates, local_search));
 
     std::vector<int> best_path;
     double best_path_length = std::numeric_limits<double>::infinity();
@@ -168,35 +830,60 @@ public:
 
     for (int iteration = 0; iteration < n_iterations; iteration++)
     {
-      std::vector<std::vector<int>> paths;
-      std::vector<std::vector<double>> path_probabilities;
+      std::vector<Tour> tours;
 
+      calculateChoice(pheromone, heuristic, choice);
       for (int ant = 0; ant < n_ants; ant++)
       {
-        auto [path, probs] = constructPath(distances, pheromone);
-        paths.push_back(path);
-        path_probabilities.push_back(probs);
+        tours.push_back(constructPath(roads, candidates, choice));
       }
 
-      std::vector<int> current_best_path;
+      // Туры улучшаются независимо, по объекту на исполнителя пула
+      if (local_search != LocalSearch::None && search_scope == SearchScope::EachTour)
+      {
+        pool.parallelFor(tours.size(), [&](size_t i, size_t slot) { improvers[slot].improve(tours[i].path, tours[i].known); });
+      }
+      else if (local_search != LocalSearch::None && !tours.empty())
+      {
+        size_t best = 0;
+        for (size_t i = 1; i < tours.size(); i++)
+        {
+          if (candidates.tourLength(tours[i].path, tours[i].known) < candidates.tourLength(tours[best].path, tours[best].known))
+          {
+            best = i;
+          }
+        }
+        improvers[0].improve(tours[best].path, tours[best].known);
+      }
+
+      std::vector<double> lengths(tours.size());
       double current_best_length = std::numeric_limits<double>::infinity();
       std::vector<double> best_path_probs;
+      size_t current_best = 0;
 
-      for (size_t i = 0; i < paths.size(); i++)
+      for (size_t i = 0; i < tours.size(); i++)
       {
-        double path_length = calculatePathLength(paths[i], distances);
-        if (path_length < current_best_length)
+        lengths[i] = candidates.tourLength(tours[i].path, tours[i].known);
+        if (lengths[i] < current_best_length)
         {
-          current_best_length = path_length;
-          current_best_path = paths[i];
-          best_path_probs = path_probabilities[i];
+          current_best_length = lengths[i];
+          current_best = i;
         }
       }
 
+      // После локального поиска тур уже не тот, что строил муравей, -
+      // вероятности его шагов пересчитываются
+      if (!tours.empty())
+      {
+        best_path_probs = local_search == LocalSearch::None
+            ? tours[current_best].probabilities
+            : replayProbabilities(tours[current_best], roads, candidates, choice);
+      }
+
       if (current_best_length < best_path_length)
       {
         best_path_length = current_best_length;
-        best_path = current_best_path;
+        best_path = tours[current_best].path;
       }
 
       std::ofstream ofile("ofile.txt", std::ios::app);
@@ -208,7 +895,8 @@ public:
         double pher_level = 0;
         for (size_t i = 0; i < best_path.size(); i++)
         {
-          pher_level += pheromone[best_path[i]][best_path[(i + 1) % best_path.size()]];
+          long edge = candidateEdge(candidates, best_path[i], best_path[(i + 1) % best_path.size()]);
+          pher_level += edge >= 0 ? pheromone[edge] : base_pheromone;
         }
 
         std::ofstream phero("pheromones.txt", std::ios::app);
@@ -224,23 +912,25 @@ public:
         prob.close();
       }
 
-      for (auto &row : pheromone)
+      for (double &p : pheromone)
       {
-        for (double &p : row)
-        {
-          p *= (1.0 - decay);
-        }
+        p *= (1.0 - decay);
       }
 
-      for (const auto &path : paths)
+      for (size_t t = 0; t < tours.size(); t++)
       {
-        double path_length = calculatePathLength(path, distances);
+        const std::vector<int> &path = tours[t].path;
         for (size_t i = 0; i < path.size(); i++)
         {
           int current = path[i];
           int next = path[(i + 1) % path.size()];
-          pheromone[current][next] += 1.0 / path_length;
-          pheromone[next][current] += 1.0 / path_length;
+          for (long edge : {candidateEdge(candidates, current, next), candidateEdge(candidates, next, current)})
+          {
+            if (edge >= 0)
+            {
+              pheromone[edge] += 1.0 / lengths[t];
+            }
+          }
         }
       }
     }
@@ -264,8 +954,9 @@ int main()
   double beta = 2.0;
 
   AntColony aco(n_ants, n_iterations, decay, alpha, beta);
-  auto distances = aco.buildGraph("if.txt");
-  aco.solve(distances);
+  aco.setLocalSearch(LocalSearch::TwoOptOrOpt);
+  Roads roads = aco.buildGraph("if.txt");
+  aco.solve(roads);
 
   return 0;
 }
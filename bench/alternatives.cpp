@@ -0,0 +1,171 @@
+// Alternative routes benchmark: exact k shortest loopless paths (Yen) against the
+// approximate plateau method, on an edge list file (ant_algorithm/if.txt) and on
+// a grid. Every returned path is checked: it must be simple, follow existing
+// edges from the source to the target and have the reported length; the first
+// path must be a shortest one and Yen's paths must come in non-decreasing order.
+//
+// build: g++ -std=c++17 -O2 -pthread bench/alternatives.cpp sources/*.cpp -o bench_alternatives
+// run:   ./bench_alternatives [edge list file] [grid side = 100] [k = 5] [queries = 20]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include "../headers/alternatives.h"
+#include "../headers/dijkstra.h"
+#include "../headers/loader.h"
+
+namespace
+{
+    // side x side grid with edges in both directions and weights 1-10
+    void buildGrid(Graph& graph, uint32_t side, std::mt19937& rng)
+    {
+        for (uint32_t i = 0; i < side * side; ++i) graph.addNode(std::to_string(i));
+
+        std::vector<Edge> edges;
+        for (uint32_t r = 0; r < side; ++r)
+        {
+            for (uint32_t c = 0; c < side; ++c)
+            {
+                NodeId here(r * side + c);
+                if (c + 1 < side)
+                {
+                    edges.push_back({here, NodeId(r * side + c + 1), Weight(1 + rng() % 10)});
+                    edges.push_back({NodeId(r * side + c + 1), here, Weight(1 + rng() % 10)});
+                }
+                if (r + 1 < side)
+                {
+                    edges.push_back({here, NodeId((r + 1) * side + c), Weight(1 + rng() % 10)});
+                    edges.push_back({NodeId((r + 1) * side + c), here, Weight(1 + rng() % 10)});
+                }
+            }
+        }
+
+        graph.addEdges(std::move(edges));
+    }
+
+    bool valid(const Graph& graph, const Way& way, NodeId source, NodeId target)
+    {
+        if (way.nodes.empty() || way.nodes.front() != source || way.nodes.back() != target)
+            return false;
+
+        std::unordered_set<NodeId> seen{source};
+        Distance length = 0;
+        for (size_t i = 1; i < way.nodes.size(); ++i)
+        {
+            if (!seen.insert(way.nodes[i]).second)
+                return false; // a loop
+
+            bool found = false;
+            for (const auto& edge : graph.node(way.nodes[i - 1])->getNeighbours())
+            {
+                if (edge.first == way.nodes[i])
+                {
+                    length = addDistance(length, edge.second);
+                    found = true;
+                }
+            }
+            if (!found)
+                return false;
+        }
+
+        return length == way.length;
+    }
+
+    struct Totals
+    {
+        double ms = 0;
+        size_t paths = 0;
+        double stretch = 0; // sum over paths of length / shortest
+        size_t bad = 0;
+    };
+
+    void account(Totals& totals, const Graph& graph, const std::vector<Way>& ways, NodeId source, NodeId target,
+                 Distance shortest, bool ordered, double ms)
+    {
+        totals.ms += ms;
+        totals.paths += ways.size();
+        for (size_t i = 0; i < ways.size(); ++i)
+        {
+            totals.stretch += double(ways[i].length) / double(shortest);
+            if (!valid(graph, ways[i], source, target) || (i == 0 && ways[i].length != shortest)
+                || (ordered && i > 0 && ways[i].length < ways[i - 1].length))
+                ++totals.bad;
+        }
+    }
+
+    double since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void compare(const char* title, const Graph& graph, size_t k, size_t queries, ThreadPool& pool, std::mt19937& rng)
+    {
+        AlternativeRoutes alternatives(graph, pool);
+        Dijkstra dijkstra(graph);
+        std::vector<NodeId> nodes = graph.getNodes();
+
+        // Only connected pairs: a path that does not exist has no alternatives either
+        Totals yen, plateaus;
+        size_t done = 0;
+        for (size_t attempt = 0; done < queries && attempt < 100 * queries; ++attempt)
+        {
+            NodeId source = nodes[rng() % nodes.size()];
+            NodeId target = nodes[rng() % nodes.size()];
+            const std::string& departure = graph.node(source)->getName();
+            const std::string& arrival = graph.node(target)->getName();
+            Distance shortest = dijkstra.shortestWay(departure, arrival).length;
+            if (source == target || shortest == unreachable)
+                continue;
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<Way> exact = alternatives.kShortest(departure, arrival, k);
+            account(yen, graph, exact, source, target, shortest, true, since(start));
+
+            start = std::chrono::steady_clock::now();
+            std::vector<Way> approximate = alternatives.plateaus(departure, arrival, k);
+            account(plateaus, graph, approximate, source, target, shortest, false, since(start));
+            ++done;
+        }
+
+        std::printf("%s: %zu nodes, %zu queries, k = %zu\n", title, graph.nodeCount(), done, k);
+        std::printf("%10s %14s %14s %14s %8s\n", "", "ms / query", "paths / query", "avg stretch", "invalid");
+        for (const auto& [name, totals] : {std::make_pair("Yen", &yen), std::make_pair("plateaus", &plateaus)})
+            std::printf("%10s %14.2f %14.2f %14.3f %8zu\n", name, totals->ms / double(done),
+                        double(totals->paths) / double(done), totals->paths ? totals->stretch / double(totals->paths) : 0.0,
+                        totals->bad);
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t side = argc > 2 ? uint32_t(std::atoi(argv[2])) : 100;
+    size_t k = argc > 3 ? size_t(std::atoi(argv[3])) : 5;
+    size_t queries = argc > 4 ? size_t(std::atoi(argv[4])) : 20;
+    std::mt19937 rng(2024);
+    ThreadPool pool;
+
+    if (argc > 1)
+    {
+        Graph graph;
+        try { graph.load(EdgeList(argv[1])); }
+        catch (const std::runtime_error& e)
+        {
+            std::fprintf(stderr, "can't open the file! %s\n", e.what());
+            return -1;
+        }
+        compare(argv[1], graph, k, queries, pool, rng);
+    }
+
+    Graph grid;
+    buildGrid(grid, side, rng);
+    std::string title = std::to_string(side) + " x " + std::to_string(side) + " grid";
+    compare(title.c_str(), grid, k, queries, pool, rng);
+
+    return 0;
+}
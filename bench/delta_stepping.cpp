@@ -0,0 +1,140 @@
+// Delta-stepping check and scaling benchmark: runs DeltaStepping from several
+// sources with 1, 2, 4 ... threads, checks every distance against Dijkstra and
+// every predecessor against the edge it claims, and reports the speedup.
+//
+// build: g++ -std=c++17 -O2 -pthread bench/delta_stepping.cpp sources/*.cpp -o bench_delta
+// run:   ./bench_delta [grid side = 500] [max threads = hardware] [delta = auto] [edge list file]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "../headers/delta_stepping.h"
+#include "../headers/dijkstra.h"
+#include "../headers/loader.h"
+
+namespace
+{
+    // side x side grid with edges in both directions and weights 1-100
+    void buildGrid(Graph& graph, uint32_t side, std::mt19937& rng)
+    {
+        for (uint32_t i = 0; i < side * side; ++i) graph.addNode(std::to_string(i));
+
+        std::vector<Edge> edges;
+        for (uint32_t r = 0; r < side; ++r)
+        {
+            for (uint32_t c = 0; c < side; ++c)
+            {
+                NodeId here(r * side + c);
+                if (c + 1 < side)
+                {
+                    edges.push_back({here, NodeId(r * side + c + 1), Weight(1 + rng() % 100)});
+                    edges.push_back({NodeId(r * side + c + 1), here, Weight(1 + rng() % 100)});
+                }
+                if (r + 1 < side)
+                {
+                    edges.push_back({here, NodeId((r + 1) * side + c), Weight(1 + rng() % 100)});
+                    edges.push_back({NodeId((r + 1) * side + c), here, Weight(1 + rng() % 100)});
+                }
+            }
+        }
+
+        graph.addEdges(std::move(edges));
+    }
+
+    // Number of nodes whose distance differs from Dijkstra or whose predecessor
+    // is not the last edge of a shortest path
+    size_t mismatches(const Graph& graph, const ShortestPathTree& tree, const std::vector<Distance>& expected)
+    {
+        size_t bad = 0;
+        for (NodeId id : graph.getNodes())
+        {
+            if (tree.distances[id.index()] != expected[id.index()])
+            {
+                ++bad;
+                continue;
+            }
+
+            NodeId parent = tree.previous[id.index()];
+            if (parent == Node::npos)
+                continue;
+
+            bool found = false;
+            for (const auto& edge : graph.node(parent)->getNeighbours())
+                if (edge.first == id && addDistance(expected[parent.index()], edge.second) == expected[id.index()]) found = true;
+            if (!found) ++bad;
+        }
+
+        return bad;
+    }
+
+    double since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t side = argc > 1 ? uint32_t(std::atoi(argv[1])) : 500;
+    size_t max_threads = argc > 2 ? size_t(std::atoi(argv[2])) : std::max(1u, std::thread::hardware_concurrency());
+    Distance delta = argc > 3 ? Distance(std::atoll(argv[3])) : 0;
+    std::mt19937 rng(2024);
+
+    Graph graph;
+    if (argc > 4)
+    {
+        try { graph.load(EdgeList(argv[4])); }
+        catch (const std::runtime_error& e)
+        {
+            std::fprintf(stderr, "can't open the file! %s\n", e.what());
+            return -1;
+        }
+    }
+    else
+        buildGrid(graph, side, rng);
+
+    std::vector<NodeId> nodes = graph.getNodes();
+    std::vector<NodeId> sources;
+    for (int i = 0; i < 5; ++i) sources.push_back(nodes[rng() % nodes.size()]);
+
+    // Reference distances and the sequential time to beat
+    BasicDijkstra<RadixHeap> dijkstra(graph);
+    BasicDijkstra<RadixHeap>::Context context;
+    std::vector<std::vector<Distance>> expected(sources.size(), std::vector<Distance>(graph.idBound().index()));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sources.size(); ++i) dijkstra.distancesFrom(sources[i], context, expected[i].data());
+    double sequential = since(start);
+
+    std::printf("%zu nodes, %zu sources, Dijkstra (radix heap): %.1f ms\n\n", nodes.size(), sources.size(), sequential);
+    std::printf("%8s %8s %10s %10s %12s %10s\n", "threads", "delta", "ms", "speedup", "vs Dijkstra", "mismatches");
+
+    double single = 0;
+    for (size_t threads = 1; ; threads = std::min(threads * 2, max_threads))
+    {
+        ThreadPool pool(threads);
+        DeltaStepping stepping(graph, pool, delta);
+
+        std::vector<ShortestPathTree> trees;
+        start = std::chrono::steady_clock::now();
+        for (NodeId source : sources) trees.push_back(stepping.shortestPaths(graph.node(source)->getName()));
+        double elapsed = since(start);
+        if (threads == 1) single = elapsed;
+
+        size_t bad = 0;
+        for (size_t i = 0; i < sources.size(); ++i) bad += mismatches(graph, trees[i], expected[i]);
+
+        std::printf("%8zu %8llu %10.1f %10.2f %12.2f %10zu\n", threads, (unsigned long long)stepping.getDelta(), elapsed,
+                    single / elapsed, sequential / elapsed, bad);
+
+        if (threads == max_threads)
+            break;
+    }
+
+    return 0;
+}
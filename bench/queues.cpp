@@ -0,0 +1,128 @@
+// Priority queue benchmark: full single-source Dijkstra (distancesFrom) with every
+// queue policy from priority_queues.h, on a grid for several weight distributions
+// and, optionally, on an edge list file such as ant_algorithm/if.txt.
+//
+// build: g++ -std=c++17 -O2 -pthread bench/queues.cpp sources/*.cpp -o bench_queues
+// run:   ./bench_queues [grid side = 300] [sources = 20] [edge list file]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "../headers/dijkstra.h"
+#include "../headers/loader.h"
+
+namespace
+{
+    using WeightGenerator = std::function<Weight(std::mt19937&)>;
+
+    // side x side grid with edges in both directions, like a street network
+    void buildGrid(Graph& graph, uint32_t side, const WeightGenerator& weight, std::mt19937& rng)
+    {
+        for (uint32_t i = 0; i < side * side; ++i) graph.addNode(std::to_string(i));
+
+        std::vector<Edge> edges;
+        for (uint32_t r = 0; r < side; ++r)
+        {
+            for (uint32_t c = 0; c < side; ++c)
+            {
+                NodeId here(r * side + c);
+                if (c + 1 < side)
+                {
+                    edges.push_back({here, NodeId(r * side + c + 1), weight(rng)});
+                    edges.push_back({NodeId(r * side + c + 1), here, weight(rng)});
+                }
+                if (r + 1 < side)
+                {
+                    edges.push_back({here, NodeId((r + 1) * side + c), weight(rng)});
+                    edges.push_back({NodeId((r + 1) * side + c), here, weight(rng)});
+                }
+            }
+        }
+
+        graph.addEdges(std::move(edges));
+    }
+
+    // Milliseconds for all searches; checksum - sum of reachable distances, to compare the queues
+    template <template <class> class Queue>
+    double run(const Graph& graph, const std::vector<NodeId>& sources, Distance& checksum)
+    {
+        BasicDijkstra<Queue> dijkstra(graph);
+        typename BasicDijkstra<Queue>::Context context;
+        std::vector<Distance> row(graph.idBound().index());
+
+        checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (NodeId source : sources)
+        {
+            dijkstra.distancesFrom(source, context, row.data());
+            for (Distance d : row)
+                if (d != unreachable) checksum += d;
+        }
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void compare(const char* title, const Graph& graph, size_t source_count, std::mt19937& rng)
+    {
+        std::vector<NodeId> nodes = graph.getNodes();
+        std::vector<NodeId> sources;
+        for (size_t i = 0; i < source_count; ++i) sources.push_back(nodes[rng() % nodes.size()]);
+
+        Distance expected, checksum;
+        double binary = run<BinaryHeap>(graph, sources, expected);
+        double times[3] = {run<RadixHeap>(graph, sources, checksum), 0, 0};
+        bool same = checksum == expected;
+        times[1] = run<DialQueue>(graph, sources, checksum);
+        same = same && checksum == expected;
+        times[2] = run<QuaternaryHeap>(graph, sources, checksum);
+        same = same && checksum == expected;
+
+        std::printf("%-28s %10.1f %10.1f %10.1f %10.1f  %s\n", title, binary, times[0], times[1], times[2],
+                    same ? "" : "DISTANCES DIFFER");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    uint32_t side = argc > 1 ? uint32_t(std::atoi(argv[1])) : 300;
+    size_t source_count = argc > 2 ? size_t(std::atoi(argv[2])) : 20;
+    std::mt19937 rng(2024);
+
+    const std::pair<const char*, WeightGenerator> distributions[] = {
+        {"unit", [](std::mt19937&) { return Weight(1); }},
+        {"uniform 1-10 (like if.txt)", [](std::mt19937& g) { return Weight(1 + g() % 10); }},
+        {"uniform 1-1000", [](std::mt19937& g) { return Weight(1 + g() % 1000); }},
+        {"uniform 1-1000000", [](std::mt19937& g) { return Weight(1 + g() % 1000000); }},
+        // mostly short streets with a few very long links (ferries, highways)
+        {"90% 1-10, 10% 10^4-10^5", [](std::mt19937& g)
+            { return g() % 10 ? Weight(1 + g() % 10) : Weight(10000 + g() % 90000); }},
+    };
+
+    std::printf("%u x %u grid, %zu full searches per queue, ms\n\n", side, side, source_count);
+    std::printf("%-28s %10s %10s %10s %10s\n", "weights", "binary", "radix", "dial", "4-ary");
+    for (const auto& [title, weight] : distributions)
+    {
+        Graph graph;
+        buildGrid(graph, side, weight, rng);
+        compare(title, graph, source_count, rng);
+    }
+
+    if (argc > 3)
+    {
+        Graph graph;
+        try { graph.load(EdgeList(argv[3])); }
+        catch (const std::runtime_error& e)
+        {
+            std::fprintf(stderr, "can't open the file! %s\n", e.what());
+            return -1;
+        }
+        compare(argv[3], graph, source_count, rng);
+    }
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef ALL_PAIRS_H
+#define ALL_PAIRS_H
+
+#include "graph.h"
+#include "thread_pool.h"
+#include "weight.h"
+
+// Плотная матрица расстояний n x n, строки подряд: (i, j) лежит в data()[i * n + j]
+class DistanceMatrix
+{
+    size_t n;
+    std::vector<Distance> cells;
+public:
+    explicit DistanceMatrix(size_t size = 0) : n(size), cells(size * size, unreachable) {}
+
+    size_t size() const { return n; }
+
+    Distance& operator()(size_t i, size_t j) { return cells[i * n + j]; }
+    Distance operator()(size_t i, size_t j) const { return cells[i * n + j]; }
+    Distance* row(size_t i) { return cells.data() + i * n; }
+    const Distance* row(size_t i) const { return cells.data() + i * n; }
+    Distance* data() { return cells.data(); }
+    const Distance* data() const { return cells.data(); }
+};
+
+// Кратчайшие расстояния между всеми парами узлов, матрица индексируется NodeId
+// (строки удалённых узлов остаются unreachable). Память O(n^2), поэтому только
+// для графов до ~10k узлов; муравьиный алгоритм её не использует, он ищет
+// расстояния Дейкстрой по спискам кандидатов
+class AllPairs
+{
+public:
+    static constexpr size_t tile = 64; // сторона блока: три блока помещаются в L2
+
+    // Матрица прямых рёбер с нулями на диагонали - вход для floydWarshall
+    static DistanceMatrix edges(const Graph& graph);
+
+    // Флойд-Уоршелл по блокам tile x tile, O(n^3): на шаге k сначала диагональный
+    // блок, затем параллельно его строка и столбец, затем параллельно все остальные
+    static void floydWarshall(DistanceMatrix& matrix, ThreadPool& pool);
+    static DistanceMatrix floydWarshall(const Graph& graph, ThreadPool& pool);
+
+    // Джонсон: Дейкстра из каждого узла, источники делятся между потоками.
+    // Веса неотрицательны, поэтому перевзвешивание Беллманом-Фордом не нужно
+    static DistanceMatrix johnson(const Graph& graph, ThreadPool& pool);
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef ALTERNATIVES_H
+#define ALTERNATIVES_H
+
+#include <memory>
+
+#include "graph.h"
+#include "search_context.h"
+#include "thread_pool.h"
+#include "way.h"
+
+// Несколько путей между парой узлов. Объект держит контексты поиска между
+// запросами, поэтому один экземпляр нельзя звать из нескольких потоков сразу
+class AlternativeRoutes
+{
+    const Graph& graph;
+    ThreadPool& pool;
+    std::vector<std::unique_ptr<SearchContext>> contexts; // по контексту на исполнителя пула
+    SearchContext estimates; // обратный поиск от цели текущего запроса kShortest
+    // Буферы plateaus: осевшие в первом обратном поиске, узлы эллипса
+    // и отложенные отсечением узлы прямого и обратного поиска
+    std::vector<NodeId> settled;
+    std::vector<NodeId> ellipse;
+    std::vector<NodeId> postponed[2];
+
+    SearchContext& context(size_t slot);
+public:
+    AlternativeRoutes(const Graph& agraph, ThreadPool& apool);
+
+    // Алгоритм Йена: до k простых путей по возрастанию длины, точно.
+    // Ответвления от очередного пути ищутся параллельно, по одному на узел
+    // пути, начиная с точки, где сам путь отошёл от предка (улучшение Лоулера).
+    // Каждое ответвление - A* с оценкой из одного обратного поиска от цели,
+    // остановленного чуть дальше начала пути
+    std::vector<Way> kShortest(std::string departure, std::string target, size_t k);
+
+    // Приближённые альтернативы через плато: два дерева кратчайших путей,
+    // прямое от departure и обратное от target, и цепочки рёбер, лежащие
+    // в обоих. Каждое плато даёт путь "к началу плато - по плато - к цели".
+    // Всего два поиска вместо сотен у Йена, но пути не обязательно k лучших.
+    // Рассматриваются пути не длиннее stretch * кратчайший; поиски раскрывают
+    // только узлы, через которые такой путь может пройти, а граница растёт
+    // от кратчайшего, пока не наберётся k путей
+    std::vector<Way> plateaus(std::string departure, std::string target, size_t k, double stretch = 1.5);
+};
+
+#endif
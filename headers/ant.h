@@ -2,13 +2,66 @@
 #define ANT_H
 
 #include "graph.h"
+#include "csr_graph.h"
+#include "random.h"
+#include "thread_pool.h"
 #include "way.h"
+#include <cmath>
+#include <memory>
 #include <random>
 
-class AntColony
+// Феромоны по индексу ребра. Испарение ленивое: хранится tau / scale,
+// поэтому испарить все рёбра - одно умножение scale. Для выбора ребра
+// хватает хранимых значений: общий множитель сокращается при нормировке
+class PheromoneTrail
 {
+    std::vector<double> stored;
+    double scale;
+
+    void normalize(); // вносит scale в значения, пока они не ушли в бесконечность
+public:
+    PheromoneTrail() : scale(1.0) {}
+
+    void assign(size_t edges, double initial);
+    size_t size() const { return stored.size(); }
+
+    double operator[](size_t edge) const { return stored[edge] * scale; } // настоящий уровень
+    double relative(size_t edge) const { return stored[edge]; }           // уровень с точностью до общего множителя
+    void evaporate(double rate);
+    void deposit(size_t edge, double amount) { stored[edge] += amount / scale; }
+};
+
+// Муравьи одной итерации строят пути параллельно на одних и тех же феромонах,
+// затем феромоны испаряются и пополняются один раз за итерацию. Муравей номер
+// ant на итерации iter берёт поток ГСЧ (seed, iter * ants + ant), а вклады
+// складываются в порядке номеров муравьёв, поэтому при одном seed результат
+// не зависит от числа потоков. W - тип веса; явные инстанцирования в ant.cpp
+template <class W>
+class BasicAntColony
+{
+public:
+    using Graph = BasicGraph<W>;
+    using CsrGraph = BasicCsrGraph<W>;
+    using Way = BasicWay<W>;
+    using Distance = DistanceOf<W>;
+private:
+    // Путь одного муравья: вершины (NodeId или вершины CSR) и индексы рёбер
+    struct AntWalk
+    {
+        std::vector<uint32_t> path;
+        std::vector<size_t> edges;
+        Distance length;
+        bool valid;
+    };
+
     Graph &graph;
-    std::map<std::pair<Node *, Node *>, double> pheromones;
+    // Рёбра графа занимают подряд идущие индексы в порядке getNeighbours():
+    // ребро i узла id - pheromones[offsets[id] + i]. Раскладка строится заново,
+    // если граф изменился
+    std::vector<size_t> offsets;
+    uint64_t layout_version;
+    PheromoneTrail pheromones;
+    PheromoneTrail edge_pheromones; // феромоны на рёбрах CSR-снимка, по индексу ребра
 
     double alpha;
     double beta;
@@ -17,22 +70,40 @@ class AntColony
 
     size_t ant_count;
     size_t iterations;
+    uint64_t seed;
+    std::unique_ptr<ThreadPool> own_pool; // для вызовов без пула, создаётся при первом таком вызове
 
-    double probability(Node *current, Node *next);
-    void updatePheromones(const Way &way);
+    ThreadPool &defaultPool();
+
+    void layout();
+    double probability(const PheromoneTrail &trail, size_t edge, W weight) const
+    {
+        return pow(trail.relative(edge), alpha) * pow(1.0 / weight, beta);
+    }
+    void updatePheromones(PheromoneTrail &trail, const std::vector<AntWalk> &walks);
+    // Общий цикл итераций; walk(trail, rng, probabilities, ant) строит путь одного муравья
+    template <class Walk>
+    std::vector<Distance> run(PheromoneTrail &trail, ThreadPool &pool, Walk &&walk, AntWalk &best);
 
 public:
-    AntColony(Graph &g, double a, double b, double evap_rate, double pher_intensity, size_t ants, size_t iters)
-        : graph(g), alpha(a), beta(b), evaporation_rate(evap_rate), pheromone_intensity(pher_intensity), ant_count(ants), iterations(iters)
+    BasicAntColony(Graph &g, double a, double b, double evap_rate, double pher_intensity, size_t ants, size_t iters,
+                   uint64_t random_seed = std::random_device{}())
+        : graph(g), layout_version(0), alpha(a), beta(b), evaporation_rate(evap_rate), pheromone_intensity(pher_intensity),
+          ant_count(ants), iterations(iters), seed(random_seed)
     {
-        for (const auto &node : graph.getNodes())
-            for (const auto &neighbour : node->getNeighbours())
-                pheromones[{node, neighbour.first}] = 1.0; // начальные феромоны
+        layout();
     }
 
-    const std::map<std::pair<Node*, Node*>, double>& getPheromoneLevels() const;
+    // Уровень феромона на ребре from -> to, 0 если ребра нет
+    double getPheromone(NodeId from, NodeId to) const;
 
-    std::pair<Way, std::vector<int>> shortestWay(const std::string departure, const std::string target);
+    // Вызовы без пула работают на собственном пуле колонии на все ядра
+    std::pair<Way, std::vector<Distance>> shortestWay(const std::string departure, const std::string target);
+    std::pair<Way, std::vector<Distance>> shortestWay(const std::string departure, const std::string target, ThreadPool &pool);
+    std::pair<Way, std::vector<Distance>> shortestWay(const CsrGraph &csr, uint32_t departure, uint32_t target);
+    std::pair<Way, std::vector<Distance>> shortestWay(const CsrGraph &csr, uint32_t departure, uint32_t target, ThreadPool &pool);
 };
 
+using AntColony = BasicAntColony<Weight>;
+
 #endif
@@ -0,0 +1,140 @@
+#ifndef ASTAR_H
+#define ASTAR_H
+
+#include <algorithm>
+#include <cmath>
+
+#include "graph.h"
+#include "landmarks.h"
+#include "way.h"
+
+struct Point
+{
+    double x;
+    double y;
+};
+
+// Эвристика - функтор Distance(NodeId node, NodeId target), нижняя
+// оценка расстояния от node до target. Она передаётся параметром шаблона,
+// поэтому вызов встраивается в цикл поиска
+
+struct ZeroHeuristic // A* с ней совпадает с Дейкстрой
+{
+    Distance operator()(NodeId, NodeId) const { return 0; }
+};
+
+// Координаты узлов хранятся по NodeId; scale переводит расстояние
+// на плоскости в единицы веса и должен быть не больше минимального
+// отношения вес/длина ребра, иначе оценка перестанет быть допустимой
+class EuclideanHeuristic
+{
+    const std::vector<Point>& points;
+    double scale;
+public:
+    EuclideanHeuristic(const std::vector<Point>& apoints, double ascale = 1.0) : points(apoints), scale(ascale) {}
+
+    Distance operator()(NodeId node, NodeId target) const
+    {
+        const Point& a = points[node.index()];
+        const Point& b = points[target.index()];
+        return Distance(std::floor(scale * std::hypot(a.x - b.x, a.y - b.y)));
+    }
+};
+
+class ManhattanHeuristic
+{
+    const std::vector<Point>& points;
+    double scale;
+public:
+    ManhattanHeuristic(const std::vector<Point>& apoints, double ascale = 1.0) : points(apoints), scale(ascale) {}
+
+    Distance operator()(NodeId node, NodeId target) const
+    {
+        const Point& a = points[node.index()];
+        const Point& b = points[target.index()];
+        return Distance(std::floor(scale * (std::fabs(a.x - b.x) + std::fabs(a.y - b.y))));
+    }
+};
+
+class AltHeuristic // ориентиры и неравенство треугольника
+{
+    const Landmarks& landmarks;
+public:
+    AltHeuristic(const Landmarks& alandmarks) : landmarks(alandmarks) {}
+
+    Distance operator()(NodeId node, NodeId target) const { return landmarks.lowerBound(node, target); }
+};
+
+template <class Heuristic>
+class AStar
+{
+    const Graph& graph;
+    Heuristic heuristic;
+    size_t settled; // сколько узлов извлечено из очереди в последнем поиске
+public:
+    AStar(const Graph& agraph, Heuristic aheuristic = Heuristic()) : graph(agraph), heuristic(aheuristic), settled(0) {}
+
+    size_t getSettled() const { return settled; }
+
+    Way shortestWay(std::string departure, std::string target)
+    {
+        NodeId begin = std::get<NodeId>(graph[departure]);
+        NodeId end = std::get<NodeId>(graph[target]);
+        std::vector<Distance> distances(graph.idBound().index(), unreachable);
+        // Значения эвристики, считаются один раз на узел; unreachable - ещё не считали
+        std::vector<Distance> estimates(graph.idBound().index(), unreachable);
+        std::vector<NodeId> previous(graph.idBound().index(), Node::npos);
+        // В очереди f = g + h
+        std::priority_queue<std::pair<Distance, NodeId>, std::vector<std::pair<Distance, NodeId>>, std::greater<>> pq;
+
+        auto estimate = [&](NodeId node)
+        {
+            Distance& h = estimates[node.index()];
+            if (h == unreachable) h = heuristic(node, end);
+            return h;
+        };
+
+        settled = 0;
+        distances[begin.index()] = 0;
+        pq.push({estimate(begin), begin});
+
+        while (!pq.empty())
+        {
+            auto [f, current] = pq.top();
+            pq.pop();
+
+            Distance current_distance = distances[current.index()];
+            if (f > addDistance(current_distance, estimate(current)))
+                continue; // устаревшая запись в очереди
+
+            ++settled;
+            if (current == end)
+                break;
+
+            for (const auto& neighbour : graph.node(current)->getNeighbours())
+            {
+                NodeId next = neighbour.first;
+                Distance new_distance = addDistance(current_distance, neighbour.second);
+
+                if (new_distance < distances[next.index()])
+                {
+                    distances[next.index()] = new_distance;
+                    previous[next.index()] = current;
+                    pq.push({addDistance(new_distance, estimate(next)), next});
+                }
+            }
+        }
+
+        Way way;
+        way.length = distances[end.index()];
+        if (way.length == unreachable)
+            return way;
+
+        for (NodeId at = end; at != Node::npos; at = previous[at.index()]) way.nodes.push_back(at);
+        std::reverse(way.nodes.begin(), way.nodes.end());
+
+        return way;
+    }
+};
+
+#endif
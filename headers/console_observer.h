@@ -0,0 +1,25 @@
+#ifndef CONSOLE_OBSERVER_H
+#define CONSOLE_OBSERVER_H
+
+#include <iostream>
+
+#include "graph_observer.h"
+
+// Прежние сообщения об удалениях, теперь только по желанию
+template <class W>
+class BasicConsoleObserver : public BasicGraphObserver<W>
+{
+    std::ostream& out;
+public:
+    explicit BasicConsoleObserver(std::ostream& aout = std::cout) : out(aout) {}
+
+    void nodeRemoved(const BasicNode<W>& node) override { out << "removed node " << node.getName() << "\n\n"; }
+    void edgeRemoved(const BasicNode<W>& from, const BasicNode<W>& to) override
+    {
+        out << "removed neighbour " << to.getName() << " from node " << from.getName() << "\n\n";
+    }
+};
+
+using ConsoleObserver = BasicConsoleObserver<Weight>;
+
+#endif
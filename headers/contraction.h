@@ -0,0 +1,53 @@
+#ifndef CONTRACTION_H
+#define CONTRACTION_H
+
+#include "graph.h"
+#include "way.h"
+
+// Contraction Hierarchies: узлы сжимаются по одному в порядке важности,
+// вместо каждого сжатого узла добавляются рёбра-сокращения. Запрос -
+// встречный поиск только вверх по рангу, затем сокращения раскрываются
+class ContractionHierarchy
+{
+    struct Arc
+    {
+        uint32_t from;
+        uint32_t to;
+        Distance weight; // сокращение может оказаться длиннее любого Weight
+        uint32_t middle; // сжатый узел внутри сокращения, npos для исходного ребра
+    };
+
+    const Graph& graph;
+    std::vector<uint32_t> rank; // порядок сжатия по NodeId
+
+    // Итоговые дуги в CSR: up - к узлам выше рангом, down - входящие от узлов выше рангом
+    std::vector<uint32_t> up_offsets, down_offsets;
+    std::vector<Arc> up_arcs, down_arcs;
+
+    // Рабочие массивы запроса, сбрасываются только по тронутым узлам
+    std::vector<Distance> distances[2];
+    std::vector<uint32_t> parents[2];
+    std::vector<uint32_t> touched;
+
+    void index(const std::vector<Arc>& arcs);
+    const Arc* findArc(uint32_t from, uint32_t to) const;
+    void unpack(uint32_t from, uint32_t to, std::vector<NodeId>& nodes) const;
+
+    explicit ContractionHierarchy(const Graph& agraph) : graph(agraph) {}
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    // witness_limit - сколько узлов может осесть в поиске свидетеля,
+    // прежде чем сокращение добавляется без доказательства его нужности
+    static ContractionHierarchy build(const Graph& graph, size_t witness_limit = 500);
+
+    // Иерархия хранится отдельно от графа и привязана к его NodeId
+    void save(const std::string& path) const;
+    static ContractionHierarchy load(const Graph& graph, const std::string& path);
+
+    size_t shortcutCount() const;
+
+    Way shortestWay(std::string departure, std::string target);
+};
+
+#endif
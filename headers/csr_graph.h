@@ -0,0 +1,77 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "node.h"
+
+template <class W> class BasicGraph;
+
+// Неизменяемый снимок графа в формате CSR: рёбра вершины v лежат
+// в targets/weights на отрезке [offsets[v], offsets[v + 1]).
+// Массивы либо принадлежат снимку (freeze), либо лежат прямо
+// в отображённом бинарном файле (open) и ничего не копируется.
+// Явные инстанцирования по типу веса W в csr_graph.cpp
+template <class W>
+class BasicCsrGraph
+{
+    uint32_t vertices;
+    uint32_t edges;
+    const uint32_t* offsets;
+    const uint32_t* targets;
+    const W* weights;
+    const uint64_t* name_offsets; // имя вершины v - names[name_offsets[v]..name_offsets[v + 1])
+    const char* names;
+    const uint32_t* by_name; // вершины, отсортированные по имени
+
+    std::vector<uint32_t> offset_storage;
+    std::vector<uint32_t> target_storage;
+    std::vector<W> weight_storage;
+    std::vector<uint32_t> by_name_storage;
+    std::vector<uint64_t> name_offset_storage; // имена копируются только в отвязанном снимке
+    std::vector<char> name_storage;
+    std::shared_ptr<const void> mapping; // держит mmap, пока жив снимок
+
+    std::vector<const BasicNode<W>*> nodes; // плотный id -> узел исходного графа, пусто для файла
+    std::vector<uint32_t> ids; // NodeId исходного графа -> плотный id
+
+    BasicCsrGraph() = default;
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    // detached - скопировать имена и не держать указатели на узлы: такой снимок
+    // переживает изменения и удаление исходного графа, node() у него nullptr
+    explicit BasicCsrGraph(const BasicGraph<W>& graph, bool detached = false);
+    BasicCsrGraph(BasicCsrGraph&&) = default; // буферы векторов при перемещении не меняют адрес
+    BasicCsrGraph& operator=(BasicCsrGraph&&) = default;
+    BasicCsrGraph(const BasicCsrGraph&) = delete;
+    BasicCsrGraph& operator=(const BasicCsrGraph&) = delete;
+
+    // Бинарный формат: заголовок, offsets/targets/weights, таблица имён.
+    // Веса пишутся в ширине W, тип веса записан в заголовке: снимок
+    // с другим весом open() не примет. Испорченный снимок (размер не совпадает
+    // с заголовком, offsets не монотонны, id за пределами vertices) - runtime_error
+    void save(const std::string& path) const;
+    static BasicCsrGraph open(const std::string& path);
+
+    uint32_t vertexCount() const { return vertices; }
+    uint32_t edgeCount() const { return edges; }
+
+    uint32_t edgesBegin(uint32_t v) const { return offsets[v]; }
+    uint32_t edgesEnd(uint32_t v) const { return offsets[v + 1]; }
+    uint32_t target(uint32_t e) const { return targets[e]; }
+    W weight(uint32_t e) const { return weights[e]; }
+
+    const BasicNode<W>* node(uint32_t v) const { return nodes.empty() ? nullptr : nodes[v]; }
+    // NodeId исходного графа или Node::npos, если снимок от графа отвязан
+    NodeId nodeId(uint32_t v) const { return nodes.empty() ? Node::npos : nodes[v]->getId(); }
+    std::string_view name(uint32_t v) const;
+    uint32_t id(NodeId node) const;
+    uint32_t id(std::string_view name) const;
+};
+
+using CsrGraph = BasicCsrGraph<Weight>;
+
+#endif
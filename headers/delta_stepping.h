@@ -0,0 +1,27 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include "graph.h"
+#include "thread_pool.h"
+#include "way.h"
+
+// Delta-stepping: узлы раскладываются по корзинам шириной delta, корзина
+// обрабатывается целиком параллельно - сначала лёгкие рёбра (вес <= delta)
+// до опустошения корзины, затем тяжёлые один раз. Узлы поделены между
+// потоками по id, у каждого свои корзины; запросы на релаксацию уходят
+// владельцу цели, поэтому расстояния пишутся без атомиков
+class DeltaStepping
+{
+    const Graph& graph;
+    ThreadPool& pool;
+    Distance delta;
+public:
+    // delta == 0 - подобрать по графу: максимальный вес, делённый на среднюю степень
+    DeltaStepping(const Graph& agraph, ThreadPool& apool, Distance adelta = 0);
+
+    Distance getDelta() const { return delta; }
+
+    ShortestPathTree shortestPaths(std::string source);
+};
+
+#endif
@@ -1,15 +1,54 @@
 #ifndef DIJKSTRA_H
 #define DIJKSTRA_H
 
+#include <memory>
+
 #include "graph.h"
+#include "csr_graph.h"
+#include "priority_queues.h"
+#include "search_context.h"
+#include "thread_pool.h"
 #include "way.h"
 
-class Dijkstra
+// Queue - политика очереди из priority_queues.h, W - тип веса. Реализация
+// в dijkstra.cpp, там же явные инстанцирования для весов uint32_t, uint64_t,
+// float, double и очередей BinaryHeap, RadixHeap, DialQueue (только целые
+// веса) и QuaternaryHeap
+template <template <class> class Queue = BinaryHeap, class W = Weight>
+class BasicDijkstra
 {
+public:
+    using Graph = BasicGraph<W>;
+    using CsrGraph = BasicCsrGraph<W>;
+    using Way = BasicWay<W>;
+    using CsrWay = BasicCsrWay<W>;
+    using Distance = DistanceOf<W>;
+    using Context = BasicSearchContext<Queue, Distance>;
+private:
     const Graph& graph;
+    std::unique_ptr<ThreadPool> own_pool; // для manyToMany без пула, создаётся при первом вызове
 public:
-    Dijkstra(const Graph& agraph) : graph(agraph) {}
+    BasicDijkstra(const Graph& agraph) : graph(agraph) {}
+    // Вызовы без контекста берут контекст текущего потока
     Way shortestWay(std::string departure, std::string target);
+    Way shortestWay(std::string departure, std::string target, Context& context);
+    // Встречный поиск: вперёд от начала и назад от конца по входящим рёбрам
+    Way bidirectionalWay(std::string departure, std::string target);
+    Way bidirectionalWay(std::string departure, std::string target, Context& forward, Context& backward);
+
+    // Один поиск до всех целей, расстояния в порядке targets
+    std::vector<Distance> oneToMany(std::string source, const std::vector<std::string>& targets);
+    std::vector<Distance> oneToMany(std::string source, const std::vector<std::string>& targets, Context& context);
+    // Полный поиск без цели: row[id] для всех id < graph.idBound()
+    void distancesFrom(NodeId source, Context& context, Distance* row);
+    // Матрица sources.size() x targets.size() по строкам; источники делятся между потоками пула
+    std::vector<Distance> manyToMany(const std::vector<std::string>& sources, const std::vector<std::string>& targets, ThreadPool& pool);
+    std::vector<Distance> manyToMany(const std::vector<std::string>& sources, const std::vector<std::string>& targets);
+
+    static Way shortestWay(const CsrGraph& csr, uint32_t departure, uint32_t target);
+    static CsrWay shortestPath(const CsrGraph& csr, uint32_t departure, uint32_t target);
 };
 
+using Dijkstra = BasicDijkstra<>;
+
 #endif
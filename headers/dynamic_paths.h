@@ -0,0 +1,45 @@
+#ifndef DYNAMIC_PATHS_H
+#define DYNAMIC_PATHS_H
+
+#include <queue>
+
+#include "graph.h"
+#include "way.h"
+
+// Дерево кратчайших путей от фиксированного источника, которое обновляется
+// вместе с графом в духе Рамалингама-Репса: при уменьшении веса поиск идёт
+// только от улучшенного узла, при увеличении или удалении ребра дерева
+// пересчитывается лишь поддерево под ним. Граф нужно менять через этот класс,
+// иначе дерево устареет
+class DynamicShortestPaths
+{
+    Graph& graph;
+    NodeId source;
+    ShortestPathTree tree;
+
+    std::vector<NodeId> affected; // поддерево, которое пересчитывается
+    std::vector<char> marked;     // marked[id] - узел в affected
+    std::priority_queue<std::pair<Distance, NodeId>, std::vector<std::pair<Distance, NodeId>>, std::greater<>> pq;
+    size_t repaired; // сколько узлов изменили расстояние при последнем обновлении
+
+    void grow(); // подогнать массивы под graph.idBound()
+    void lower(NodeId from, NodeId to, Weight weight);
+    void collect(NodeId root);
+    void recompute();
+    void propagate();
+public:
+    DynamicShortestPaths(Graph& agraph, std::string asource);
+
+    // Вставка ребра или смена веса существующего. Удалённые и несуществующие
+    // узлы пропускаются, как в самом графе
+    void setEdge(NodeId from, NodeId to, Weight weight);
+    void removeEdge(NodeId from, NodeId to);
+    void removeNode(NodeId id);
+
+    Distance distance(NodeId id) const { return id.index() < tree.distances.size() ? tree.distances[id.index()] : unreachable; }
+    Way shortestWay(std::string target) const;
+    const ShortestPathTree& getTree() const { return tree; }
+    size_t getRepaired() const { return repaired; }
+};
+
+#endif
@@ -1,23 +1,88 @@
 #ifndef GRAPH_H
 #define GRAPH_H
 
+#include <atomic>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+
 #include "node.h"
 
-class Graph
+template <class W> class BasicCsrGraph;
+template <class W> class BasicEdgeList;
+template <class W> class BasicGraphObserver;
+
+template <class W>
+struct BasicEdge
+{
+    NodeId departure;
+    NodeId target;
+    W weight;
+};
+
+// Граф владеет узлами: узлы и списки смежности живут в пуле памяти,
+// снаружи на них ссылаются по NodeId. W - тип веса ребра; реализация
+// и явные инстанцирования для uint32_t, uint64_t, float и double в graph.cpp
+template <class W>
+class BasicGraph
 {
-    std::set<Node*> nodes;
+    static_assert(std::is_floating_point_v<W> || std::is_unsigned_v<W>, "weights are non-negative");
+public:
+    using Node = BasicNode<W>;
+    using Edge = BasicEdge<W>;
+    using CsrGraph = BasicCsrGraph<W>;
+    using EdgeList = BasicEdgeList<W>;
+    using Observer = BasicGraphObserver<W>;
+private:
+    // Пул берёт у системы крупные блоки и отдаёт их разом вместе с графом,
+    // память удалённых узлов и рёбер переиспользуется
+    std::pmr::unsynchronized_pool_resource pool;
+
+    std::pmr::unordered_map<std::string_view, Node*> index{&pool}; // имя -> узел, ключи ссылаются на Node::name
+    std::pmr::vector<Node*> byId{&pool}; // id -> узел, после удаления остаётся nullptr
+    size_t count = 0; // живых узлов
+    // Растёт при каждом изменении через методы графа; по нему кэши узнают,
+    // что их ответы устарели. Рёбра меняются только через граф
+    std::atomic<uint64_t> version{0};
+    Observer* observer = nullptr;
 public:
-    ~Graph();
+    BasicGraph() = default;
+    BasicGraph(const BasicGraph&) = delete;
+    BasicGraph& operator=(const BasicGraph&) = delete;
+    ~BasicGraph();
 
-    void addNode(Node* node) { nodes.insert(node); }
-    void removeNode(Node* node);
-    void addEdge(Node* begin, Node* end, size_t weight) { begin->addNeighbour(end, weight); }
-    void removeEdge(Node* begin, Node* end) { begin->removeNeighbour(end); }
+    NodeId addNode(std::string_view name); // если узел с таким именем уже есть, возвращает его id
+    void removeNode(NodeId id); // O(входящие + исходящие) по спискам inbound
+    // Повторное ребро к тому же соседу объединяется по policy. Рёбра удалённых
+    // и несуществующих узлов пропускаются, здесь и в addEdges
+    void addEdge(NodeId begin, NodeId end, W weight, DuplicatePolicy policy = DuplicatePolicy::KeepMin);
+    // Пачка рёбер: сортировка, схлопывание повторов по policy и слияние
+    // со списками смежности за один проход, O(N log N) на всю пачку
+    void addEdges(std::vector<Edge> edges, DuplicatePolicy policy = DuplicatePolicy::KeepMin);
+    void removeEdge(NodeId begin, NodeId end);
+    void load(const EdgeList& list); // добавляет все рёбра списка, создавая недостающие узлы
     void show() const;
 
-    const std::set<Node*>& getNodes() const { return nodes; }
-    
-    std::variant<Node*, std::monostate> operator[](const std::string l) const;
+    CsrGraph freeze() const; // CSR-снимок для запросов на чтение
+    CsrGraph detach() const; // то же, но имена скопированы и снимок не ссылается на узлы графа
+    void save(const std::string& path) const; // бинарный снимок, открывается через CsrGraph::open
+
+    std::vector<NodeId> getNodes() const; // id живых узлов по возрастанию
+    size_t nodeCount() const { return count; }
+    // nullptr - отписаться; граф наблюдателем не владеет
+    void setObserver(Observer* aobserver) { observer = aobserver; }
+
+    uint64_t getVersion() const { return version.load(std::memory_order_acquire); }
+
+    NodeId idBound() const { return NodeId(byId.size()); } // все id узлов меньше этой границы
+    // Имя и рёбра узла; nullptr, если узла с таким id нет
+    const Node* node(NodeId id) const { return id.index() < byId.size() ? byId[id.index()] : nullptr; }
+    std::variant<NodeId, std::monostate> id(std::string_view l) const;
+
+    std::variant<NodeId, std::monostate> operator[](std::string_view l) const { return id(l); }
 };
 
+using Edge = BasicEdge<Weight>;
+using Graph = BasicGraph<Weight>;
+
 #endif
@@ -0,0 +1,23 @@
+#ifndef GRAPH_OBSERVER_H
+#define GRAPH_OBSERVER_H
+
+#include "node.h"
+
+// Подписчик на изменения графа, подключается через BasicGraph::setObserver.
+// Без подписчика событие стоит одной проверки указателя, а сборка graph.cpp
+// с -DGRAPH_NO_EVENTS убирает и её. Печать в поток - console_observer.h
+template <class W>
+class BasicGraphObserver
+{
+public:
+    virtual ~BasicGraphObserver() = default;
+
+    virtual void nodeAdded(const BasicNode<W>&) {}
+    virtual void nodeRemoved(const BasicNode<W>&) {} // узел ещё жив, его рёбра уже удалены
+    virtual void edgeAdded(const BasicNode<W>&, const BasicNode<W>&, W) {}
+    virtual void edgeRemoved(const BasicNode<W>&, const BasicNode<W>&) {}
+};
+
+using GraphObserver = BasicGraphObserver<Weight>;
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include "graph.h"
+
+// Предрасчёт для эвристики ALT: расстояния от каждого ориентира
+// до всех узлов и от всех узлов до ориентира
+class Landmarks
+{
+    size_t count;
+    std::vector<Distance> from; // from[v * count + l] - расстояние от ориентира l до v
+    std::vector<Distance> to;   // to[v * count + l] - расстояние от v до ориентира l
+    std::vector<NodeId> chosen;
+
+    static std::vector<Distance> distancesFrom(const Graph& graph, NodeId source, bool reverse);
+public:
+    // Ориентиры выбираются жадно: каждый следующий - самый дальний от уже выбранных
+    Landmarks(const Graph& graph, size_t landmark_count);
+
+    const std::vector<NodeId>& getLandmarks() const { return chosen; }
+
+    // Нижняя оценка расстояния от node до target по неравенству треугольника
+    Distance lowerBound(NodeId node, NodeId target) const;
+};
+
+#endif
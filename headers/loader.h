@@ -0,0 +1,42 @@
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "weight.h"
+
+template <class W>
+struct BasicEdgeRecord
+{
+    std::string_view departure; // указывают прямо в отображённый файл
+    std::string_view target;
+    W weight;
+};
+
+// Список рёбер "откуда куда вес", отображённый в память через mmap.
+// Файл режется на куски по границам строк, куски разбираются параллельно.
+// Веса разбираются в тип W; явные инстанцирования в loader.cpp
+template <class W>
+class BasicEdgeList
+{
+    const char* data;
+    size_t size;
+    std::vector<BasicEdgeRecord<W>> edges;
+
+    static void parse(const char* begin, const char* end, std::vector<BasicEdgeRecord<W>>& out);
+public:
+    explicit BasicEdgeList(const std::string& path, unsigned threads = std::thread::hardware_concurrency());
+    BasicEdgeList(const BasicEdgeList&) = delete;
+    BasicEdgeList& operator=(const BasicEdgeList&) = delete;
+    ~BasicEdgeList();
+
+    const std::vector<BasicEdgeRecord<W>>& getEdges() const { return edges; }
+};
+
+using EdgeRecord = BasicEdgeRecord<Weight>;
+using EdgeList = BasicEdgeList<Weight>;
+
+#endif
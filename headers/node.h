@@ -1,26 +1,92 @@
 #ifndef NODE_H
 #define NODE_H
 
+#include <cstdint>
 #include <iostream>
 #include <limits>
 #include <vector>
 #include <queue>
 #include <set>
 #include <map>
+#include <memory_resource>
+#include <functional>
 
-class Node
+#include "weight.h"
+
+// Плотный номер узла внутри графа. Отдельный тип, а не uint32_t, чтобы номер
+// узла не путался с весом, номером вершины CSR или индексом массива;
+// index() - явный выход к числу. По умолчанию - Node::npos
+class NodeId
+{
+    uint32_t value;
+public:
+    constexpr NodeId() : value(std::numeric_limits<uint32_t>::max()) {}
+    constexpr explicit NodeId(uint32_t avalue) : value(avalue) {}
+
+    constexpr uint32_t index() const { return value; }
+
+    constexpr bool operator==(NodeId other) const { return value == other.value; }
+    constexpr bool operator!=(NodeId other) const { return value != other.value; }
+    constexpr bool operator<(NodeId other) const { return value < other.value; }
+    constexpr bool operator>(NodeId other) const { return value > other.value; }
+    constexpr bool operator<=(NodeId other) const { return value <= other.value; }
+    constexpr bool operator>=(NodeId other) const { return value >= other.value; }
+
+    NodeId& operator++() { ++value; return *this; }
+};
+
+namespace std
+{
+    template <>
+    struct hash<NodeId>
+    {
+        size_t operator()(NodeId id) const { return hash<uint32_t>()(id.index()); }
+    };
+}
+
+// Что делать, если ребро к тому же соседу добавляют повторно
+enum class DuplicatePolicy { KeepMin, KeepMax, KeepLast, Sum };
+
+template <class W>
+W combineWeights(W old_weight, W new_weight, DuplicatePolicy policy);
+
+template <class W>
+class BasicGraph;
+
+// W - тип веса; реализация и явные инстанцирования в node.cpp
+template <class W>
+class BasicNode
 {
+    friend class BasicGraph<W>;
+public:
+    // Сосед хранится номером: 8 байт на ребро uint32_t вместо 16 с указателем
+    using Edges = std::pmr::vector<std::pair<NodeId, W>>;
+private:
     const std::string name;
-    std::set<std::pair<Node*, size_t>> neighbours;
+    NodeId id;
+    Edges neighbours; // отсортированы по id соседа, по одному ребру на соседа
+    Edges inbound; // входящие рёбра (откуда, вес), в том же порядке
+
+    // Слияние отсортированной пачки со списком за один проход; в sorted
+    // записываются итоговые веса рёбер
+    static void merge(Edges& edges, std::vector<std::pair<NodeId, W>>& sorted, DuplicatePolicy policy);
+    static void upsert(Edges& edges, NodeId other, W weight);
+    static bool erase(Edges& edges, NodeId other); // false, если ребра не было
+    // Вес ребра к other или nullptr
+    static W* find(Edges& edges, NodeId other);
 public:
-    Node(const std::string& aname) : name(aname) {}
+    static constexpr NodeId npos = NodeId();
 
-    const std::string& getName() const { return name; }
-    const std::set<std::pair<Node*, size_t>>& getNeighbours() const { return neighbours; }
+    BasicNode(const std::string& aname, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : name(aname), id(npos), neighbours(resource), inbound(resource) {}
 
-    void addNeighbour(Node* neighbour, size_t weight) { neighbours.insert(std::make_pair(neighbour, weight)); }
-    void removeNeighbour(Node* neighbour);
-    void clearNeighbours();
+    const std::string& getName() const { return name; }
+    NodeId getId() const { return id; }
+    // Рёбра меняются только через граф: ему нужно обновить входящие списки соседей
+    const Edges& getNeighbours() const { return neighbours; }
+    const Edges& getInbound() const { return inbound; }
 };
 
+using Node = BasicNode<Weight>;
+
 #endif
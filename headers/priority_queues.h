@@ -0,0 +1,264 @@
+#ifndef PRIORITY_QUEUES_H
+#define PRIORITY_QUEUES_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "node.h"
+
+// Очереди с приоритетом для Дейкстры, шаблоны по типу расстояния D. Общий интерфейс:
+//   reset(bound)        - новый запрос, id вершин меньше bound
+//   push(priority, id)  - добавить вершину или понизить ей приоритет
+//   top() / pop()       - минимальная пара (priority, id)
+//   empty() / size()
+// Очереди без decrease-key оставляют устаревшие записи, их отсекает сам поиск.
+// RadixHeap и DialQueue монотонные: приоритеты не меньше последнего извлечённого,
+// что выполняется для Дейкстры с неотрицательными весами
+
+// Двоичная куча с ленивым удалением - прежнее поведение
+template <class D>
+class BinaryHeap
+{
+    std::vector<std::pair<D, NodeId>> heap;
+public:
+    void reset(NodeId) { heap.clear(); }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    std::pair<D, NodeId> top() const { return heap.front(); }
+    void push(D priority, NodeId id)
+    {
+        heap.emplace_back(priority, id);
+        std::push_heap(heap.begin(), heap.end(), std::greater<>());
+    }
+    std::pair<D, NodeId> pop()
+    {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<>());
+        auto top = heap.back();
+        heap.pop_back();
+        return top;
+    }
+};
+
+// Радиксная куча: корзина i хранит ключи, отличающиеся от последнего
+// извлечённого в старшем бите i - 1. Каждая запись переезжает не больше 64 раз.
+// Неотрицательные double упорядочены так же, как их биты, поэтому дробные
+// расстояния кладутся по битовому представлению
+template <class D>
+class RadixHeap
+{
+    std::vector<std::pair<D, NodeId>> buckets[65];
+    uint64_t last;
+    size_t count;
+
+    static uint64_t key(D priority)
+    {
+        if constexpr (std::is_floating_point_v<D>)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &priority, sizeof(bits));
+            return bits;
+        }
+        else
+            return priority;
+    }
+    static int bucket(uint64_t key, uint64_t last) { return key == last ? 0 : 64 - __builtin_clzll(key ^ last); }
+
+    // Переносит минимум в корзину 0, раскладывая первую непустую корзину
+    void refill()
+    {
+        if (!buckets[0].empty())
+            return;
+
+        int i = 1;
+        while (buckets[i].empty()) ++i;
+
+        last = key(std::min_element(buckets[i].begin(), buckets[i].end())->first);
+        for (const auto& entry : buckets[i]) buckets[bucket(key(entry.first), last)].push_back(entry);
+        buckets[i].clear();
+    }
+public:
+    RadixHeap() : last(0), count(0) {}
+
+    void reset(NodeId)
+    {
+        for (auto& b : buckets) b.clear();
+        last = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    std::pair<D, NodeId> top()
+    {
+        refill();
+        return buckets[0].back();
+    }
+    void push(D priority, NodeId id)
+    {
+        buckets[bucket(key(priority), last)].emplace_back(priority, id);
+        ++count;
+    }
+    std::pair<D, NodeId> pop()
+    {
+        auto entry = top();
+        buckets[0].pop_back();
+        --count;
+        return entry;
+    }
+};
+
+// Очередь Дайала: кольцо корзин по одной на значение расстояния.
+// Все ключи в очереди лежат в [current, current + max weight], поэтому
+// кольца длиннее максимального веса хватает; оно растёт при необходимости.
+// Только для целых весов
+template <class D>
+class DialQueue
+{
+    static_assert(std::is_integral_v<D>, "Dial's buckets need integer distances");
+
+    std::vector<std::vector<std::pair<D, NodeId>>> buckets; // размер - степень двойки
+    D current;
+    size_t count;
+
+    void grow(size_t span)
+    {
+        size_t capacity = buckets.size();
+        while (capacity < span) capacity *= 2;
+
+        std::vector<std::vector<std::pair<D, NodeId>>> old(capacity);
+        old.swap(buckets);
+        for (auto& b : old)
+            for (const auto& entry : b) buckets[entry.first & (capacity - 1)].push_back(entry);
+    }
+public:
+    DialQueue() : buckets(64), current(0), count(0) {}
+
+    void reset(NodeId)
+    {
+        if (count > 0)
+            for (auto& b : buckets) b.clear();
+        current = 0;
+        count = 0;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    std::pair<D, NodeId> top()
+    {
+        while (buckets[current & (buckets.size() - 1)].empty()) ++current;
+        return buckets[current & (buckets.size() - 1)].back();
+    }
+    void push(D priority, NodeId id)
+    {
+        if (size_t(priority - current) >= buckets.size())
+            grow(size_t(priority - current) + 1);
+
+        buckets[priority & (buckets.size() - 1)].emplace_back(priority, id);
+        ++count;
+    }
+    std::pair<D, NodeId> pop()
+    {
+        auto entry = top();
+        buckets[current & (buckets.size() - 1)].pop_back();
+        --count;
+        return entry;
+    }
+};
+
+// Индексированная 4-арная куча с decrease-key: у каждой вершины не больше
+// одной записи, устаревших записей не бывает
+template <class D>
+class QuaternaryHeap
+{
+    static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+
+    std::vector<std::pair<D, NodeId>> heap;
+    std::vector<uint32_t> position; // индекс вершины в heap или absent
+
+    void place(size_t i, std::pair<D, NodeId> entry)
+    {
+        heap[i] = entry;
+        position[entry.second.index()] = uint32_t(i);
+    }
+    void siftUp(size_t i)
+    {
+        auto entry = heap[i];
+        while (i > 0 && entry.first < heap[(i - 1) / 4].first)
+        {
+            place(i, heap[(i - 1) / 4]);
+            i = (i - 1) / 4;
+        }
+        place(i, entry);
+    }
+    void siftDown(size_t i)
+    {
+        auto entry = heap[i];
+        for (;;)
+        {
+            size_t first = 4 * i + 1;
+            if (first >= heap.size())
+                break;
+
+            size_t best = first;
+            for (size_t c = first + 1; c < std::min(first + 4, heap.size()); ++c)
+                if (heap[c].first < heap[best].first) best = c;
+
+            if (heap[best].first >= entry.first)
+                break;
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, entry);
+    }
+public:
+    void reset(NodeId bound)
+    {
+        // Остатки прошлого запроса - O(размера кучи), а не O(bound)
+        for (const auto& entry : heap) position[entry.second.index()] = absent;
+        heap.clear();
+        if (position.size() < bound.index()) position.resize(bound.index(), absent);
+    }
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    std::pair<D, NodeId> top() const { return heap.front(); }
+    void push(D priority, NodeId id)
+    {
+        uint32_t at = position[id.index()];
+        if (at != absent)
+        {
+            if (priority < heap[at].first)
+            {
+                heap[at].first = priority;
+                siftUp(at);
+            }
+            return;
+        }
+
+        heap.emplace_back(priority, id);
+        siftUp(heap.size() - 1);
+    }
+    std::pair<D, NodeId> pop()
+    {
+        auto entry = heap.front();
+        position[entry.second.index()] = absent;
+
+        auto tail = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap[0] = tail;
+            siftDown(0);
+        }
+
+        return entry;
+    }
+};
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef PUBLISHER_H
+#define PUBLISHER_H
+
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "csr_graph.h"
+
+// Публикация неизменяемых снимков в стиле RCU. Писатель собирает новую
+// версию (например, graph.detach()) и подменяет её одним атомарным обменом,
+// читатели закрепляют текущий снимок без блокировок. Старые версии
+// освобождаются по эпохам: снимок, снятый в эпоху E, удаляется, когда
+// ни один читатель не закреплён в эпохе <= E
+class SnapshotPublisher
+{
+    // Слот читателя на отдельной кэш-линии; 0 - читатель ничего не держит
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> taken{false};
+    };
+
+    struct Retired
+    {
+        const CsrGraph* graph;
+        uint64_t epoch; // эпоха, в которой снимок перестал быть текущим
+    };
+
+    std::atomic<const CsrGraph*> current;
+    std::atomic<uint64_t> global_epoch{1};
+    std::unique_ptr<Slot[]> slots;
+    size_t slot_count;
+
+    mutable std::mutex writer; // писатели публикуют по очереди
+    std::vector<Retired> retired;
+
+    void reclaimLocked();
+public:
+    // Закреплённый снимок: пока Pin жив, снимок не удалят
+    class Pin
+    {
+        friend class SnapshotPublisher;
+
+        Slot* slot;
+        const CsrGraph* graph;
+
+        Pin(Slot* aslot, const CsrGraph* agraph) : slot(aslot), graph(agraph) {}
+    public:
+        Pin(Pin&& other) noexcept : slot(other.slot), graph(other.graph) { other.slot = nullptr; }
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+        ~Pin() { if (slot) slot->epoch.store(0, std::memory_order_release); }
+
+        const CsrGraph& operator*() const { return *graph; }
+        const CsrGraph* operator->() const { return graph; }
+    };
+
+    // Регистрация потока-читателя: слот берётся один раз, дальше pin()
+    // стоит два атомарных обращения. У читателя не больше одного Pin за раз
+    class Reader
+    {
+        friend class SnapshotPublisher;
+
+        SnapshotPublisher* publisher;
+        Slot* slot;
+
+        Reader(SnapshotPublisher* apublisher, Slot* aslot) : publisher(apublisher), slot(aslot) {}
+    public:
+        Reader(Reader&& other) noexcept : publisher(other.publisher), slot(other.slot) { other.slot = nullptr; }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader() { if (slot) slot->taken.store(false, std::memory_order_release); }
+
+        Pin pin();
+    };
+
+    explicit SnapshotPublisher(CsrGraph initial, size_t max_readers = 64);
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+    ~SnapshotPublisher(); // к этому моменту читателей быть не должно
+
+    Reader reader(); // бросает runtime_error, если все слоты заняты
+
+    void publish(CsrGraph next);
+    void reclaim(); // освободить то, что уже никто не держит; publish делает это сам
+
+    uint64_t epoch() const { return global_epoch.load(); }
+    size_t pending() const; // снятые с публикации, но ещё не освобождённые снимки
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// xoshiro256** - 32 байта состояния и несколько тактов на число вместо
+// 5 КБ у std::mt19937. Поток задаётся одним 64-битным числом через splitmix64,
+// так что потоки (seed, 0), (seed, 1), ... дешёво создавать под каждую задачу
+class Xoshiro256
+{
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+public:
+    static uint64_t splitmix(uint64_t& x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    explicit Xoshiro256(uint64_t seed = 0) { reseed(seed); }
+    Xoshiro256(uint64_t seed, uint64_t stream) { reseed(seed, stream); }
+
+    void reseed(uint64_t seed)
+    {
+        for (uint64_t& word : state) word = splitmix(seed);
+    }
+    // Независимый поток номер stream; не зависит от того, какой поток ОС его берёт
+    void reseed(uint64_t seed, uint64_t stream)
+    {
+        uint64_t mixed = seed;
+        reseed(splitmix(mixed) ^ stream);
+    }
+
+    uint64_t operator()()
+    {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    double uniform() { return double((*this)() >> 11) * 0x1.0p-53; } // [0, 1)
+};
+
+#endif
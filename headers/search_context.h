@@ -0,0 +1,68 @@
+#ifndef SEARCH_CONTEXT_H
+#define SEARCH_CONTEXT_H
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "node.h"
+#include "priority_queues.h"
+
+// Рабочие массивы одного поиска с плоской индексацией по NodeId.
+// Значение действительно, только если его поколение совпадает с текущим,
+// поэтому сброс между запросами стоит O(1), а память не перевыделяется.
+// D - тип расстояния; инстанцирования для uint64_t и double в search_context.cpp
+template <class D>
+class BasicSearchLabels
+{
+    std::vector<D> distances;
+    std::vector<NodeId> previous;
+    std::vector<uint32_t> stamps; // поколение, в котором записан узел
+    std::vector<uint32_t> marks;  // поколение, в котором узел помечен (цели и т. п.)
+    uint32_t generation;
+public:
+    BasicSearchLabels() : generation(0) {}
+
+    void reset(NodeId bound); // начать новый запрос на графе с idBound() == bound
+
+    D distance(NodeId id) const { return reached(id) ? distances[id.index()] : unreachableOf<D>; }
+    // Node::npos у источника и недостижимых
+    NodeId parent(NodeId id) const { return reached(id) ? previous[id.index()] : Node::npos; }
+    bool reached(NodeId id) const { return stamps[id.index()] == generation; }
+    void set(NodeId id, D distance, NodeId parent)
+    {
+        stamps[id.index()] = generation;
+        distances[id.index()] = distance;
+        previous[id.index()] = parent;
+    }
+
+    bool marked(NodeId id) const { return marks[id.index()] == generation; }
+    void mark(NodeId id) { marks[id.index()] = generation; }
+    void unmark(NodeId id) { marks[id.index()] = 0; }
+};
+
+// Метки плюс очередь выбранной политики (см. priority_queues.h).
+// Один контекст на поток: серверный поток держит его между запросами
+template <template <class> class Queue = BinaryHeap, class D = Distance>
+class BasicSearchContext : public BasicSearchLabels<D>
+{
+    Queue<D> queue; // буфер очереди тоже живёт между запросами
+public:
+    void reset(NodeId bound)
+    {
+        BasicSearchLabels<D>::reset(bound);
+        queue.reset(bound);
+    }
+
+    bool empty() const { return queue.empty(); }
+    size_t size() const { return queue.size(); }
+    std::pair<D, NodeId> top() { return queue.top(); }
+    void push(D distance, NodeId id) { queue.push(distance, id); }
+    std::pair<D, NodeId> pop() { return queue.pop(); }
+};
+
+using SearchLabels = BasicSearchLabels<Distance>;
+
+using SearchContext = BasicSearchContext<>;
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Пул потоков с общей очередью задач. wait() нельзя вызывать из задачи
+// этого же пула - она будет ждать сама себя
+class ThreadPool
+{
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::condition_variable finished;
+    size_t active;
+    bool stopping;
+
+    void work();
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t size() const { return workers.size(); }
+
+    void submit(std::function<void()> task);
+    void wait(); // пока очередь не опустеет и все задачи не завершатся
+
+    // body(index, slot) для index из [0, count); slot < size() - номер
+    // исполнителя, по нему удобно держать состояние на поток
+    template <class Body>
+    void parallelFor(size_t count, Body&& body)
+    {
+        std::atomic<size_t> next{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        for (size_t slot = 0; slot < size(); ++slot)
+        {
+            submit([&, slot]
+            {
+                try
+                {
+                    for (size_t index = next++; index < count; index = next++) body(index, slot);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                    next = count; // остальным исполнителям дальше не брать
+                }
+            });
+        }
+
+        wait();
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+#endif
@@ -3,11 +3,32 @@
 
 #include "node.h"
 
-struct Way
+// Длина пути - в типе расстояния для веса W
+template <class W>
+struct BasicWay
 {
-    std::vector<Node*> nodes;
-    int length;
-    Way() : length(std::numeric_limits<int>::max()) {}
+    std::vector<NodeId> nodes;
+    DistanceOf<W> length;
+    BasicWay() : length(unreachableOf<DistanceOf<W>>) {}
+};
+
+// Путь по плотным id вершин CSR-снимка; снимку из файла не нужны объекты Node
+template <class W>
+struct BasicCsrWay
+{
+    std::vector<uint32_t> vertices;
+    DistanceOf<W> length;
+    BasicCsrWay() : length(unreachableOf<DistanceOf<W>>) {}
+};
+
+using Way = BasicWay<Weight>;
+using CsrWay = BasicCsrWay<Weight>;
+
+// Кратчайшие пути от одного источника до всех узлов, по NodeId
+struct ShortestPathTree
+{
+    std::vector<Distance> distances; // unreachable для недостижимых
+    std::vector<NodeId> previous;    // Node::npos у источника и недостижимых
 };
 
 #endif
@@ -0,0 +1,77 @@
+#ifndef WAY_CACHE_H
+#define WAY_CACHE_H
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "graph.h"
+#include "way.h"
+
+struct CacheStats
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;     // вытеснены по LRU
+    uint64_t invalidations; // найдены, но граф с тех пор менялся
+};
+
+// LRU-кэш готовых путей по паре (откуда, куда) перед любым движком поиска.
+// Ключи разбиты на шарды со своим мьютексом, поэтому потоки с разными
+// парами почти не мешают друг другу. Запись помнит версию графа, при
+// которой посчитана, и после любого изменения графа считается промахом
+class WayCache
+{
+    struct Entry
+    {
+        std::string key;
+        uint64_t version;
+        Way way;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::list<Entry> order; // спереди - недавно использованные
+        std::unordered_map<std::string_view, std::list<Entry>::iterator> entries; // ключи ссылаются на Entry::key
+        CacheStats stats{};
+    };
+
+    const Graph& graph;
+    size_t shard_capacity;
+    std::unique_ptr<Shard[]> shards;
+    size_t shard_count;
+
+    static std::string makeKey(const std::string& departure, const std::string& target);
+    Shard& shardFor(const std::string& key) const;
+public:
+    WayCache(const Graph& agraph, size_t capacity, size_t shard_count = 16);
+
+    bool find(const std::string& departure, const std::string& target, Way& way);
+    // version - версия графа, прочитанная до начала поиска: если граф успел
+    // поменяться, запись сразу окажется устаревшей
+    void store(const std::string& departure, const std::string& target, const Way& way, uint64_t version);
+
+    // Путь из кэша или compute() с запоминанием результата, например
+    // cache.get(a, b, [&] { return dijkstra.shortestWay(a, b); })
+    template <class Compute>
+    Way get(const std::string& departure, const std::string& target, Compute&& compute)
+    {
+        Way way;
+        if (find(departure, target, way))
+            return way;
+
+        uint64_t version = graph.getVersion();
+        way = compute();
+        store(departure, target, way, version);
+
+        return way;
+    }
+
+    CacheStats stats() const; // сумма по шардам
+    void clear();
+};
+
+#endif
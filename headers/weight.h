@@ -0,0 +1,37 @@
+#ifndef WEIGHT_H
+#define WEIGHT_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+// Тип веса ребра - параметр шаблонов (BasicGraph<W>, BasicDijkstra<Queue, W>,
+// BasicAntColony<W> ...), они явно инстанцированы для uint32_t, uint64_t,
+// float и double. Расстояния всегда шире весов: uint64_t для целых, double для дробных
+template <class W>
+using DistanceOf = std::conditional_t<std::is_floating_point_v<W>, double, uint64_t>;
+
+// "Недостижимо": для целых - максимум типа, для дробных - бесконечность
+template <class D>
+inline constexpr D unreachableOf = std::numeric_limits<D>::has_infinity
+    ? std::numeric_limits<D>::infinity() : std::numeric_limits<D>::max();
+
+// Сложение с насыщением: длинный путь упирается в unreachableOf<D>, а не переполняется.
+// Тип берётся из первого слагаемого, второе может быть и весом ребра
+template <class D>
+constexpr D addDistance(D a, std::common_type_t<D> b)
+{
+    static_assert(std::is_same_v<D, uint64_t> || std::is_same_v<D, double>, "the first term must be a distance");
+
+    if constexpr (std::is_floating_point_v<D>)
+        return a + b;
+    else
+        return a > unreachableOf<D> - b ? unreachableOf<D> : a + b;
+}
+
+// Вес по умолчанию - для Graph, Dijkstra, Way и остальных псевдонимов без параметра
+using Weight = uint32_t;
+using Distance = DistanceOf<Weight>;
+constexpr Distance unreachable = unreachableOf<Distance>;
+
+#endif
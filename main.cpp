@@ -1,14 +1,19 @@
-#include <fstream>
+#include <filesystem>
 #include <iostream>
 #include <stdexcept>
 
 #include "headers/graph.h"
 #include "headers/dijkstra.h"
+#include "headers/alternatives.h"
+#include "headers/astar.h"
+#include "headers/contraction.h"
+#include "headers/delta_stepping.h"
+#include "headers/loader.h"
 
 // like 'typedef' or 'using'
-Node* take(const std::variant<Node*, std::monostate> v)
+NodeId take(const std::variant<NodeId, std::monostate> v)
 {
-    if (std::holds_alternative<Node*>(v)) return std::get<Node*>(v);
+    if (std::holds_alternative<NodeId>(v)) return std::get<NodeId>(v);
     throw std::bad_variant_access();
 }
 
@@ -17,50 +22,35 @@ int main(int argc, char* argv[])
     Graph graph;
     
     // Filling the graph
-    std::ifstream inputFile(argv[1]);
-    if (!inputFile.is_open())
+    try { graph.load(EdgeList(argv[1])); }
+    catch (const std::runtime_error& e)
     {
-        std::cerr << "can't open the file!" << std::endl;
+        std::cerr << "can't open the file! " << e.what() << std::endl;
         
         return -1;
     }
     
-    std::string departure, target;
-    size_t weight;
-    
-    while (inputFile >> departure >> target >> weight)
-    {
-        if (!std::holds_alternative<Node*>(graph[departure])) graph.addNode(new Node(departure));
-        if (!std::holds_alternative<Node*>(graph[target])) graph.addNode(new Node(target));
-        
-        graph.addEdge(take(graph[departure]), take(graph[target]), weight);
-    }
-    
-    inputFile.close();
-    
     // Graph testing
     /* std::cout << "[Graph testing]\n" << std::endl;
     
-    Node* x = new Node("7");
-    graph.addNode(x);
-    x->addNeighbour(take(graph["7"]), 4);
-    (*x).addNeighbour(take(graph["1"]), 5);
+    NodeId x = graph.addNode("7");
+    graph.addEdge(x, take(graph["7"]), 4);
+    graph.addEdge(x, take(graph["1"]), 5);
     
-    Node* y = new Node("8");
-    graph.addNode(y);
-    y->addNeighbour(x, 1);
-    (*y).addNeighbour(take(graph["3"]), 8);
+    NodeId y = graph.addNode("8");
+    graph.addEdge(y, x, 1);
+    graph.addEdge(y, take(graph["3"]), 8);
     
     graph.show();
     
-    try { take(graph["7"])->removeNeighbour(take(graph["1"])); }
+    try { graph.removeEdge(take(graph["7"]), take(graph["1"])); }
     catch (const std::bad_variant_access& e) { std::cout << "exception: bad_variant_access!" << std::endl; }
     
     graph.show();
     
     graph.removeNode(take(graph["3"]));
     graph.removeEdge(x, take(graph["3"]));
-    take(graph["1"])->addNeighbour(y, 6);
+    graph.addEdge(take(graph["1"]), y, 6);
     
     graph.show(); */
     
@@ -71,8 +61,82 @@ int main(int argc, char* argv[])
     Way way1 = dijkstra.shortestWay("0", "874");
 
     std::cout << "shortest path found by Dijkstra: ";
-    for (Node* node : way1.nodes) std::cout << node->getName() << " ";
+    for (NodeId id : way1.nodes) std::cout << graph.node(id)->getName() << " ";
     std::cout << "\nlength: " << way1.length << '\n' << std::endl;
+
+    Way bidirectional = dijkstra.bidirectionalWay("0", "874");
+
+    std::cout << "shortest path found by bidirectional Dijkstra: ";
+    for (NodeId id : bidirectional.nodes) std::cout << graph.node(id)->getName() << " ";
+    std::cout << "\nlength: " << bidirectional.length << '\n' << std::endl;
+
+    // A* with landmark (ALT) heuristic
+    Landmarks landmarks(graph, 8);
+    AStar astar(graph, AltHeuristic(landmarks));
+    Way way4 = astar.shortestWay("0", "874");
+
+    std::cout << "shortest path found by A* (ALT): ";
+    for (NodeId id : way4.nodes) std::cout << graph.node(id)->getName() << " ";
+    std::cout << "\nlength: " << way4.length << ", settled nodes: " << astar.getSettled() << '\n' << std::endl;
+
+    // Contraction Hierarchies
+    ContractionHierarchy hierarchy = ContractionHierarchy::build(graph);
+    Way way5 = hierarchy.shortestWay("0", "874");
+
+    std::cout << "shortest path found by contraction hierarchies: ";
+    for (NodeId id : way5.nodes) std::cout << graph.node(id)->getName() << " ";
+    std::cout << "\nlength: " << way5.length << ", shortcuts: " << hierarchy.shortcutCount() << '\n' << std::endl;
+
+    // Parallel delta-stepping from the source to every node
+    ThreadPool pool;
+    DeltaStepping stepping(graph, pool);
+    ShortestPathTree tree = stepping.shortestPaths("0");
+
+    std::vector<NodeId> way6;
+    for (NodeId at = take(graph["874"]); at != Node::npos; at = tree.previous[at.index()]) way6.insert(way6.begin(), at);
+
+    std::cout << "shortest path found by delta-stepping: ";
+    for (NodeId id : way6) std::cout << graph.node(id)->getName() << " ";
+    std::cout << "\nlength: " << tree.distances[take(graph["874"]).index()] << ", delta: " << stepping.getDelta() << '\n' << std::endl;
+
+    // Alternative routes: exact Yen and approximate plateaus
+    // 0 -> 874 has a single path, so the demo pair is one with several
+    AlternativeRoutes alternatives(graph, pool);
+    std::vector<Way> yen = alternatives.kShortest("72", "880", 3);
+    std::vector<Way> plateaus = alternatives.plateaus("72", "880", 3);
+
+    std::cout << "k shortest loopless paths from 72 to 880 (Yen):\n";
+    for (const Way& way : yen)
+    {
+        for (NodeId id : way.nodes) std::cout << graph.node(id)->getName() << " ";
+        std::cout << "- length " << way.length << '\n';
+    }
+    std::cout << "alternatives via plateaus:\n";
+    for (const Way& way : plateaus)
+    {
+        for (NodeId id : way.nodes) std::cout << graph.node(id)->getName() << " ";
+        std::cout << "- length " << way.length << '\n';
+    }
+    std::cout << std::endl;
+
+    // Dijkstra on the CSR snapshot
+    CsrGraph csr = graph.freeze();
+    Way way2 = Dijkstra::shortestWay(csr, csr.id(take(graph["0"])), csr.id(take(graph["874"])));
+
+    std::cout << "shortest path found by Dijkstra on CSR: ";
+    for (NodeId id : way2.nodes) std::cout << graph.node(id)->getName() << " ";
+    std::cout << "\nlength: " << way2.length << '\n' << std::endl;
+
+    // Dijkstra straight from the mapped binary snapshot
+    // The snapshot path is the second argument, a file in the temp directory by default
+    std::string snapshot = argc > 2 ? argv[2] : (std::filesystem::temp_directory_path() / "graph.bin").string();
+    graph.save(snapshot);
+    CsrGraph mapped = CsrGraph::open(snapshot);
+    CsrWay way3 = Dijkstra::shortestPath(mapped, mapped.id("0"), mapped.id("874"));
+
+    std::cout << "shortest path found by Dijkstra on the snapshot: ";
+    for (uint32_t v : way3.vertices) std::cout << mapped.name(v) << " ";
+    std::cout << "\nlength: " << way3.length << '\n' << std::endl;
     std::cout << "----------------------------------------------------------------------\n" << std::endl;
 
     return 0;
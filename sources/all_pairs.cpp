@@ -0,0 +1,163 @@
+#include "../headers/all_pairs.h"
+#include "../headers/dijkstra.h"
+
+#include <algorithm>
+#include <memory>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define ALL_PAIRS_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    // row[j] = min(row[j], to_k + through[j]) без ветвлений: перенос при сложении
+    // превращается в маску, и сумма упирается в unreachable, а не переполняется.
+    // В такой форме цикл векторизуется (-O3 с SSE4.2 или AVX2, -fopt-info-vec)
+    void relaxRowScalar(Distance* row, const Distance* through, Distance to_k, size_t count)
+    {
+        static_assert(unreachable == ~Distance(0), "the saturation mask relies on unreachable being all ones");
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            Distance sum = to_k + through[j];
+            sum |= Distance(0) - Distance(sum < to_k);
+            row[j] = std::min(row[j], sum);
+        }
+    }
+
+#ifdef ALL_PAIRS_AVX2_DISPATCH
+    // То же по 4 элемента. Беззнакового сравнения 64-битных чисел в AVX2 нет:
+    // после инверсии старшего бита подходит знаковое
+    __attribute__((target("avx2"))) void relaxRowAvx2(Distance* row, const Distance* through, Distance to_k, size_t count)
+    {
+        const __m256i sign = _mm256_set1_epi64x(int64_t(uint64_t(1) << 63));
+        const __m256i base = _mm256_set1_epi64x(int64_t(to_k));
+        const __m256i base_flipped = _mm256_xor_si256(base, sign);
+
+        size_t j = 0;
+        for (; j + 4 <= count; j += 4)
+        {
+            __m256i sum = _mm256_add_epi64(base, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through + j)));
+            sum = _mm256_or_si256(sum, _mm256_cmpgt_epi64(base_flipped, _mm256_xor_si256(sum, sign)));
+            __m256i sum_flipped = _mm256_xor_si256(sum, sign);
+
+            __m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+            __m256i shorter = _mm256_cmpgt_epi64(_mm256_xor_si256(old, sign), sum_flipped);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + j), _mm256_blendv_epi8(old, sum, shorter));
+        }
+        relaxRowScalar(row + j, through + j, to_k, count - j);
+    }
+
+    bool hasAvx2()
+    {
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+    }
+#endif
+
+    void relaxRow(Distance* row, const Distance* through, Distance to_k, size_t count)
+    {
+#ifdef ALL_PAIRS_AVX2_DISPATCH
+        if (hasAvx2())
+        {
+            relaxRowAvx2(row, through, to_k, count);
+            return;
+        }
+#endif
+        relaxRowScalar(row, through, to_k, count);
+    }
+
+    // Блок (bi, bj) через промежуточные узлы блока bk. Внешний цикл по kk,
+    // поэтому блок можно обновлять на месте, даже если он совпадает с bi или bj.
+    // Строка блока обновляется векторным ядром: AVX2-версия выбирается при
+    // запуске, так что флаг -mavx2 не нужен
+    void relaxTile(DistanceMatrix& matrix, size_t bi, size_t bj, size_t bk)
+    {
+        size_t n = matrix.size();
+        size_t i_end = std::min(n, (bi + 1) * AllPairs::tile);
+        size_t j_begin = bj * AllPairs::tile, j_end = std::min(n, (bj + 1) * AllPairs::tile);
+        size_t k_end = std::min(n, (bk + 1) * AllPairs::tile);
+
+        for (size_t k = bk * AllPairs::tile; k < k_end; ++k)
+        {
+            const Distance* through = matrix.row(k);
+            for (size_t i = bi * AllPairs::tile; i < i_end; ++i)
+            {
+                Distance to_k = matrix(i, k);
+                if (to_k != unreachable)
+                    relaxRow(matrix.row(i) + j_begin, through + j_begin, to_k, j_end - j_begin);
+            }
+        }
+    }
+}
+
+DistanceMatrix AllPairs::edges(const Graph& graph)
+{
+    DistanceMatrix matrix(graph.idBound().index());
+    for (NodeId id : graph.getNodes())
+    {
+        matrix(id.index(), id.index()) = 0;
+        for (const auto& neighbour : graph.node(id)->getNeighbours())
+        {
+            Distance& cell = matrix(id.index(), neighbour.first.index());
+            cell = std::min(cell, Distance(neighbour.second));
+        }
+    }
+
+    return matrix;
+}
+
+void AllPairs::floydWarshall(DistanceMatrix& matrix, ThreadPool& pool)
+{
+    size_t blocks = (matrix.size() + tile - 1) / tile;
+
+    for (size_t k = 0; k < blocks; ++k)
+    {
+        relaxTile(matrix, k, k, k);
+
+        // Строка и столбец блока k зависят только от диагонального блока
+        pool.parallelFor(2 * blocks, [&](size_t index, size_t)
+        {
+            size_t other = index % blocks;
+            if (other == k)
+                return;
+
+            if (index < blocks) relaxTile(matrix, k, other, k);
+            else relaxTile(matrix, other, k, k);
+        });
+
+        // Остальные блоки читают только строку и столбец k, пишут каждый своё
+        pool.parallelFor(blocks * blocks, [&](size_t index, size_t)
+        {
+            size_t i = index / blocks, j = index % blocks;
+            if (i != k && j != k) relaxTile(matrix, i, j, k);
+        });
+    }
+}
+
+DistanceMatrix AllPairs::floydWarshall(const Graph& graph, ThreadPool& pool)
+{
+    DistanceMatrix matrix = edges(graph);
+    floydWarshall(matrix, pool);
+
+    return matrix;
+}
+
+DistanceMatrix AllPairs::johnson(const Graph& graph, ThreadPool& pool)
+{
+    DistanceMatrix matrix(graph.idBound().index());
+    BasicDijkstra<RadixHeap> dijkstra(graph);
+
+    std::vector<std::unique_ptr<BasicDijkstra<RadixHeap>::Context>> contexts(pool.size());
+    pool.parallelFor(graph.idBound().index(), [&](size_t id, size_t slot)
+    {
+        if (graph.node(NodeId(uint32_t(id))) == nullptr)
+            return;
+
+        if (!contexts[slot]) contexts[slot] = std::make_unique<BasicDijkstra<RadixHeap>::Context>();
+        dijkstra.distancesFrom(NodeId(uint32_t(id)), *contexts[slot], matrix.row(id));
+    });
+
+    return matrix;
+}
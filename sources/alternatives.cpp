@@ -0,0 +1,391 @@
+#include "../headers/alternatives.h"
+
+#include <algorithm>
+#include <map>
+#include <optional>
+
+namespace
+{
+    // Путь по id с длинами префиксов: prefix[i] - расстояние от начала до nodes[i]
+    struct Route
+    {
+        std::vector<NodeId> nodes;
+        std::vector<Distance> prefix;
+        size_t deviation; // индекс узла, от которого путь ответвился от предка
+    };
+
+    // Запас для обратного поиска kShortest: оценки точны до slack * d(source, target),
+    // дальше - нижняя граница. Ответвления уходят от кратчайшего пути недалеко
+    constexpr double estimate_slack = 1.25;
+
+    // Оценка расстояния до цели по обратному поиску, остановленному на bound:
+    // осевшие узлы - точно, остальные - не ближе bound. Если поиск исчерпал
+    // граф (bound == unreachable), неосевшие узлы до цели не доходят
+    Distance estimate(const SearchContext& estimates, Distance bound, NodeId id)
+    {
+        return std::min(estimates.distance(id), bound);
+    }
+
+    // A* от spur до target в обход помеченных узлов корня и рёбер
+    // spur -> banned, по которым уже ушли найденные пути с тем же корнем.
+    // Оценка - расстояние до target без запретов (или bound за границей
+    // обратного поиска): запреты его только увеличивают, поэтому оценка
+    // допустима и согласована
+    bool spurSearch(const Graph& graph, SearchContext& context, NodeId spur, NodeId target, const std::vector<NodeId>& root,
+                    const std::vector<NodeId>& banned, const SearchContext& estimates, Distance bound)
+    {
+        context.reset(graph.idBound());
+        for (NodeId id : root) context.mark(id);
+
+        context.set(spur, 0, Node::npos);
+        context.push(estimate(estimates, bound, spur), spur);
+
+        while (!context.empty())
+        {
+            auto [key, current_id] = context.pop();
+            if (current_id == target)
+                return true;
+            if (key > addDistance(context.distance(current_id), estimate(estimates, bound, current_id)))
+                continue;
+
+            Distance current_distance = context.distance(current_id);
+            for (const auto& neighbour : graph.node(current_id)->getNeighbours())
+            {
+                NodeId next = neighbour.first;
+                Distance remaining = estimate(estimates, bound, next);
+                if (context.marked(next) || remaining == unreachable)
+                    continue;
+                if (current_id == spur && std::find(banned.begin(), banned.end(), next) != banned.end())
+                    continue;
+
+                Distance new_distance = addDistance(current_distance, neighbour.second);
+                if (new_distance < context.distance(next))
+                {
+                    context.set(next, new_distance, current_id);
+                    context.push(addDistance(new_distance, remaining), next);
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // Продолжает Дейкстру в context по исходящим (backward == false) или входящим
+    // рёбрам, пока ключ в голове очереди не больше bound(). Осевший узел раскрывается,
+    // только если expand(id, distance) - так поиск отсекает заведомо лишние узлы.
+    // Очередь не очищается: поиск можно продолжить с другой границей
+    template <class Bound, class Expand>
+    void advance(const Graph& graph, SearchContext& context, bool backward, Bound bound, Expand expand)
+    {
+        while (!context.empty() && context.top().first <= bound())
+        {
+            auto [current_distance, current_id] = context.pop();
+            if (current_distance > context.distance(current_id) || !expand(current_id, current_distance))
+                continue;
+
+            const Node* current = graph.node(current_id);
+            for (const auto& neighbour : backward ? current->getInbound() : current->getNeighbours())
+            {
+                Distance new_distance = addDistance(current_distance, neighbour.second);
+                if (new_distance < context.distance(neighbour.first))
+                {
+                    context.set(neighbour.first, new_distance, current_id);
+                    context.push(new_distance, neighbour.first);
+                }
+            }
+        }
+    }
+
+    void start(const Graph& graph, SearchContext& context, NodeId source)
+    {
+        context.reset(graph.idBound());
+        context.set(source, 0, Node::npos);
+        context.push(0, source);
+    }
+
+    // Поиск от source, пока не осядет goal, и дальше до stretch * d(goal).
+    // Возвращает эту границу (unreachable, если goal недостижим и граф исчерпан)
+    Distance boundedSearch(const Graph& graph, SearchContext& context, NodeId source, NodeId goal, double stretch, bool backward)
+    {
+        start(graph, context, source);
+
+        Distance limit = unreachable;
+        advance(graph, context, backward, [&] { return limit; }, [&](NodeId id, Distance distance)
+        {
+            if (id == goal) limit = Distance(double(distance) * stretch);
+            return true;
+        });
+
+        return limit;
+    }
+
+    Way toWay(const std::vector<NodeId>& nodes, Distance length)
+    {
+        Way way;
+        way.length = length;
+        way.nodes = nodes;
+
+        return way;
+    }
+
+    // До k путей через плато узлов ellipse (помечены в backward): пути не длиннее
+    // границы эллипса, короткие вперёд
+    std::vector<Way> collectPlateaus(const SearchContext& forward, const SearchContext& backward,
+                                     const std::vector<NodeId>& ellipse, size_t k)
+    {
+        auto through = [&](NodeId id) { return addDistance(forward.distance(id), backward.distance(id)); };
+        auto onPlateau = [&](NodeId id, NodeId next) { return forward.parent(next) == id && backward.marked(next); };
+
+        // Начало плато: ребро к следующему узлу обратного дерева есть и в прямом,
+        // а ребро от предыдущего узла прямого дерева - нет
+        struct Plateau
+        {
+            Distance length;   // длина пути через плато
+            Distance span;     // длина самого плато
+            NodeId start;
+        };
+        std::vector<Plateau> plateaus;
+        for (NodeId id : ellipse)
+        {
+            NodeId next = backward.parent(id);
+            if (next == Node::npos || !onPlateau(id, next))
+                continue;
+
+            NodeId previous = forward.parent(id);
+            if (previous != Node::npos && backward.parent(previous) == id)
+                continue;
+
+            NodeId stop = id;
+            for (NodeId at = next; at != Node::npos && onPlateau(stop, at); at = backward.parent(stop)) stop = at;
+            plateaus.push_back({through(id), forward.distance(stop) - forward.distance(id), id});
+        }
+
+        // Короткие пути вперёд, при равной длине - с длинным плато; порядок
+        // не зависит от порядка обхода эллипса
+        std::sort(plateaus.begin(), plateaus.end(), [](const Plateau& a, const Plateau& b)
+        {
+            if (a.length != b.length) return a.length < b.length;
+            return a.span != b.span ? a.span > b.span : a.start < b.start;
+        });
+
+        std::vector<Way> ways;
+        std::vector<NodeId> nodes;
+        for (const Plateau& plateau : plateaus)
+        {
+            if (ways.size() >= k)
+                break;
+
+            nodes.clear();
+            for (NodeId at = plateau.start; at != Node::npos; at = forward.parent(at)) nodes.push_back(at);
+            std::reverse(nodes.begin(), nodes.end());
+            for (NodeId at = backward.parent(plateau.start); at != Node::npos; at = backward.parent(at)) nodes.push_back(at);
+
+            // Ветви двух деревьев могут пересечься - такой путь с петлёй не берём
+            std::vector<NodeId> sorted = nodes;
+            std::sort(sorted.begin(), sorted.end());
+            if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+                continue;
+
+            ways.push_back(toWay(nodes, plateau.length));
+        }
+
+        return ways;
+    }
+}
+
+AlternativeRoutes::AlternativeRoutes(const Graph& agraph, ThreadPool& apool)
+    : graph(agraph), pool(apool), contexts(std::max<size_t>(apool.size(), 2))
+{
+}
+
+SearchContext& AlternativeRoutes::context(size_t slot)
+{
+    if (!contexts[slot]) contexts[slot] = std::make_unique<SearchContext>();
+    return *contexts[slot];
+}
+
+std::vector<Way> AlternativeRoutes::kShortest(std::string departure, std::string target, size_t k)
+{
+    NodeId begin = std::get<NodeId>(graph[departure]);
+    NodeId end = std::get<NodeId>(graph[target]);
+
+    std::vector<Route> found;
+    std::vector<Way> ways;
+    if (k == 0)
+        return ways;
+
+    // Обратный поиск от цели до estimate_slack * d: оценки для ответвлений и сразу
+    // первый путь. Узлы дальше границы получают оценку bound, полный обход графа не нужен
+    Distance bound = boundedSearch(graph, estimates, end, begin, estimate_slack, true);
+    if (!estimates.reached(begin))
+        return ways;
+
+    Route shortest;
+    shortest.deviation = 0;
+    for (NodeId at = begin; at != Node::npos; at = estimates.parent(at)) shortest.nodes.push_back(at);
+    for (NodeId id : shortest.nodes) shortest.prefix.push_back(estimates.distance(begin) - estimates.distance(id));
+    found.push_back(std::move(shortest));
+
+    // Кандидаты по (длина, узлы) - одинаковые пути от разных ответвлений схлопываются
+    std::map<std::pair<Distance, std::vector<NodeId>>, std::pair<std::vector<Distance>, size_t>> candidates;
+
+    while (found.size() < k)
+    {
+        const Route& last = found.back();
+        size_t spurs = last.nodes.size() - 1 - last.deviation;
+
+        std::vector<std::optional<Route>> branches(spurs);
+        pool.parallelFor(spurs, [&](size_t index, size_t slot)
+        {
+            size_t i = last.deviation + index;
+            NodeId spur = last.nodes[i];
+            std::vector<NodeId> root(last.nodes.begin(), last.nodes.begin() + i);
+
+            // Рёбра из spur, по которым уже ушли пути с тем же корнем
+            std::vector<NodeId> banned;
+            for (const Route& route : found)
+                if (route.nodes.size() > i + 1 && std::equal(last.nodes.begin(), last.nodes.begin() + i + 1, route.nodes.begin()))
+                    banned.push_back(route.nodes[i + 1]);
+
+            SearchContext& search = context(slot);
+            if (!spurSearch(graph, search, spur, end, root, banned, estimates, bound))
+                return;
+
+            Route branch;
+            branch.deviation = i;
+            branch.nodes = std::move(root);
+            branch.prefix.assign(last.prefix.begin(), last.prefix.begin() + i);
+
+            size_t joint = branch.nodes.size();
+            for (NodeId at = end; at != Node::npos; at = search.parent(at)) branch.nodes.push_back(at);
+            std::reverse(branch.nodes.begin() + joint, branch.nodes.end());
+            for (size_t j = joint; j < branch.nodes.size(); ++j)
+                branch.prefix.push_back(addDistance(last.prefix[i], search.distance(branch.nodes[j])));
+
+            branches[index] = std::move(branch);
+        });
+
+        // Слияние в порядке узлов пути - результат не зависит от числа потоков
+        for (auto& branch : branches)
+        {
+            if (!branch)
+                continue;
+
+            Distance length = branch->prefix.back();
+            candidates.emplace(std::make_pair(length, std::move(branch->nodes)), std::make_pair(std::move(branch->prefix), branch->deviation));
+        }
+
+        if (candidates.empty())
+            break;
+
+        auto best = candidates.begin();
+        Route next;
+        next.nodes = best->first.second;
+        next.prefix = std::move(best->second.first);
+        next.deviation = best->second.second;
+        candidates.erase(best);
+        found.push_back(std::move(next));
+    }
+
+    for (const Route& route : found) ways.push_back(toWay(route.nodes, route.prefix.back()));
+
+    return ways;
+}
+
+std::vector<Way> AlternativeRoutes::plateaus(std::string departure, std::string target, size_t k, double stretch)
+{
+    NodeId begin = std::get<NodeId>(graph[departure]);
+    NodeId end = std::get<NodeId>(graph[target]);
+
+    std::vector<Way> ways;
+    SearchContext& forward = context(0);
+    SearchContext& backward = context(1);
+    if (k == 0)
+        return ways;
+
+    // Нужны узлы "эллипса" f(v) + b(v) <= limit. Узлы на кратчайших путях
+    // к узлу эллипса сами лежат в эллипсе, поэтому поиски, отсекающие всё
+    // остальное по нижней оценке, находят f и b эллипса точно.
+    // 1. Обратный поиск до начала: d и оценка min(b, d) снизу для любого узла
+    bool arrived = false;
+    start(graph, backward, end);
+    settled.clear();
+    advance(graph, backward, true, [&] { return arrived ? Distance(0) : unreachable; }, [&](NodeId id, Distance)
+    {
+        arrived = arrived || id == begin;
+        settled.push_back(id);
+        return true;
+    });
+    if (!arrived)
+        return ways;
+
+    Distance shortest = backward.distance(begin);
+    Distance full = Distance(double(shortest) * stretch);
+    auto lower = [&](NodeId id) { return std::min(backward.distance(id), shortest); };
+
+    start(graph, forward, begin);
+    ellipse.clear();
+    for (auto& nodes : postponed) nodes.clear();
+
+    // Граница растёт долями запаса stretch: хорошие пути обычно чуть длиннее
+    // кратчайшего, и узкий эллипс в разы меньше полного. Плато с путём не
+    // длиннее границы не зависят от неё самой, поэтому если k путей нашлось
+    // раньше, это те же k путей, что и с полной границей. Отсечённые узлы
+    // откладываются и возвращаются в очередь в следующем круге
+    for (Distance share : {Distance(16), Distance(4), Distance(1)})
+    {
+        Distance limit = shortest + (full - shortest) / share;
+
+        // 2. Прямой поиск раскрывает только узлы, через которые может пройти путь не длиннее limit
+        for (NodeId id : postponed[0]) forward.push(forward.distance(id), id);
+        postponed[0].clear();
+        advance(graph, forward, false, [&] { return limit; }, [&](NodeId id, Distance distance)
+        {
+            if (addDistance(distance, lower(id)) > limit)
+            {
+                postponed[0].push_back(id);
+                return false;
+            }
+            forward.mark(id);
+            return true;
+        });
+
+        // 3. Обратный поиск продолжается только по узлам эллипса; метка backward
+        // означает "узел в эллипсе", осевшие на шаге 1 узлы проверяются отдельно
+        auto inside = [&](NodeId id, Distance distance)
+        {
+            return forward.marked(id) && addDistance(forward.distance(id), distance) <= limit;
+        };
+        auto enter = [&](NodeId id)
+        {
+            backward.mark(id);
+            ellipse.push_back(id);
+        };
+        settled.erase(std::remove_if(settled.begin(), settled.end(), [&](NodeId id)
+        {
+            if (!inside(id, backward.distance(id)))
+                return false;
+            enter(id);
+            return true;
+        }), settled.end());
+
+        for (NodeId id : postponed[1]) backward.push(backward.distance(id), id);
+        postponed[1].clear();
+        advance(graph, backward, true, [&] { return limit; }, [&](NodeId id, Distance distance)
+        {
+            if (!inside(id, distance))
+            {
+                postponed[1].push_back(id);
+                return false;
+            }
+            enter(id);
+            return true;
+        });
+
+        ways = collectPlateaus(forward, backward, ellipse, k);
+        if (ways.size() >= k)
+            break;
+    }
+
+    return ways;
+}
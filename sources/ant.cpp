@@ -1,138 +1,262 @@
 #include "../headers/ant.h"
 
-double AntColony::probability(Node *current, Node *next)
+#include <algorithm>
+#include <cmath>
+
+void PheromoneTrail::assign(size_t edges, double initial)
+{
+    stored.assign(edges, initial);
+    scale = 1.0;
+}
+
+void PheromoneTrail::evaporate(double rate)
+{
+    scale *= 1 - rate;
+    if (scale < 1e-30)
+        normalize(); // раз в сотни итераций, а не на каждой
+}
+
+void PheromoneTrail::normalize()
+{
+    for (double &pheromone : stored) pheromone *= scale;
+    scale = 1.0;
+}
+
+template <class W>
+void BasicAntColony<W>::layout()
 {
-    auto neighbours = current->getNeighbours();
-    auto edge_it = std::find_if(
-        neighbours.begin(),
-        neighbours.end(),
-        [next](const auto &pair)
-        { return pair.first == next; });
-
-    if (edge_it == neighbours.end())
+    if (!offsets.empty() && layout_version == graph.getVersion())
+        return;
+
+    layout_version = graph.getVersion();
+    offsets.assign(graph.idBound().index() + 1, 0);
+    for (NodeId id(0); id < graph.idBound(); ++id)
+    {
+        const auto *node = graph.node(id);
+        offsets[id.index() + 1] = offsets[id.index()] + (node != nullptr ? node->getNeighbours().size() : 0);
+    }
+
+    // Индексы рёбер сдвинулись - прежние уровни не к чему привязать
+    pheromones.assign(offsets.back(), 1.0); // начальные феромоны
+}
+
+template <class W>
+double BasicAntColony<W>::getPheromone(NodeId from, NodeId to) const
+{
+    const auto *node = graph.node(from);
+    if (node == nullptr || from.index() + 1 >= offsets.size())
         return 0.0;
 
-    double tau = pheromones[{current, next}]; // уровень феромонов
-    double eta = 1.0 / edge_it->second;       // обратное значение веса ребра
+    const auto &neighbours = node->getNeighbours();
+    auto it = std::lower_bound(neighbours.begin(), neighbours.end(), to,
+                               [](const std::pair<NodeId, W> &edge, NodeId id) { return edge.first < id; });
+    if (it == neighbours.end() || it->first != to)
+        return 0.0;
 
-    return pow(tau, alpha) * pow(eta, beta);
+    return pheromones[offsets[from.index()] + size_t(it - neighbours.begin())];
 }
 
-void AntColony::updatePheromones(const Way &way)
+template <class W>
+void BasicAntColony<W>::updatePheromones(PheromoneTrail &trail, const std::vector<AntWalk> &walks)
 {
-    // глобальное обновление феромонов
-    for (auto &[edge, pheromone] : pheromones)
-        pheromone *= (1 - evaporation_rate); // испарение
+    // глобальное обновление феромонов, раз за итерацию
+    trail.evaporate(evaporation_rate);
 
-    // локальное обновление для лучшего пути
-    double Q = pheromone_intensity;
-    for (size_t i = 0; i < way.nodes.size() - 1; ++i)
+    // вклады муравьёв, дошедших до цели, в порядке их номеров
+    for (const AntWalk &walk : walks)
     {
-        Node *current = way.nodes[i];
-        Node *next = way.nodes[i + 1];
-        pheromones[{current, next}] += Q / way.length;
+        if (!walk.valid)
+            continue;
+
+        for (size_t e : walk.edges)
+            trail.deposit(e, pheromone_intensity / double(walk.length));
     }
 }
 
-std::pair<Way, std::vector<int>> AntColony::shortestWay(const std::string departure, const std::string target)
+template <class W>
+ThreadPool &BasicAntColony<W>::defaultPool()
+{
+    if (!own_pool) own_pool = std::make_unique<ThreadPool>();
+    return *own_pool;
+}
+
+template <class W>
+template <class Walk>
+std::vector<DistanceOf<W>> BasicAntColony<W>::run(PheromoneTrail &trail, ThreadPool &pool, Walk &&walk, AntWalk &best)
 {
-    Node *start = std::get<Node *>(graph[departure]);
-    Node *end = std::get<Node *>(graph[target]);
+    std::vector<Distance> best_lengths_per_iteration; // вектор для хранения длин оптимальных путей
+    std::vector<AntWalk> walks(ant_count);
+    std::vector<std::vector<double>> probabilities(pool.size()); // буфер на исполнителя пула
 
-    Way best_way;
-    std::vector<int> best_lengths_per_iteration; // вектор для хранения длин оптимальных путей
+    best.valid = false;
+    best.length = unreachableOf<Distance>;
 
     for (size_t iter = 0; iter < iterations; ++iter)
     {
-        for (size_t ant = 0; ant < ant_count; ++ant)
+        // Пока муравьи строят пути, феромоны только читаются
+        pool.parallelFor(ant_count, [&](size_t ant, size_t slot)
+        {
+            Xoshiro256 rng(seed, iter * ant_count + ant);
+            AntWalk &current = walks[ant];
+            current.path.clear();
+            current.edges.clear();
+            current.length = 0;
+            current.valid = walk(trail, rng, probabilities[slot], current);
+        });
+
+        for (const AntWalk &current : walks)
+            if (current.valid && (!best.valid || current.length < best.length)) best = current;
+
+        updatePheromones(trail, walks);
+        best_lengths_per_iteration.push_back(best.length);
+    }
+
+    return best_lengths_per_iteration;
+}
+
+template <class W>
+std::pair<BasicWay<W>, std::vector<DistanceOf<W>>> BasicAntColony<W>::shortestWay(const std::string departure, const std::string target)
+{
+    return shortestWay(departure, target, defaultPool());
+}
+
+template <class W>
+std::pair<BasicWay<W>, std::vector<DistanceOf<W>>> BasicAntColony<W>::shortestWay(const std::string departure, const std::string target, ThreadPool &pool)
+{
+    NodeId start = std::get<NodeId>(graph[departure]);
+    NodeId end = std::get<NodeId>(graph[target]);
+    layout();
+
+    auto walk = [&](const PheromoneTrail &trail, Xoshiro256 &rng, std::vector<double> &probabilities, AntWalk &ant)
+    {
+        NodeId current = start;
+        ant.path.push_back(current.index());
+
+        while (current != end)
         {
-            Node *current = start;
-            Way way;
-            int distance = 0;
-            bool valid_path = true;
+            const auto &neighbours = graph.node(current)->getNeighbours(); // без копии списка
+            size_t first = offsets[current.index()];
+            if (neighbours.empty())
+                return false;
 
-            while (current != end)
+            probabilities.clear();
+            double total_prob = 0;
+            for (size_t i = 0; i < neighbours.size(); ++i)
             {
-                way.nodes.push_back(current);
+                double prob = probability(trail, first + i, neighbours[i].second);
+                probabilities.push_back(prob);
+                total_prob += prob;
+            }
+
+            if (total_prob == 0)
+                return false;
+
+            double rand_prob = rng.uniform() * total_prob;
+            double cumulative_prob = 0;
+            size_t chosen = neighbours.size() - 1; // на случай ошибки округления
 
-                if (current->getNeighbours().empty() && current != end)
+            for (size_t i = 0; i < neighbours.size(); ++i)
+            {
+                cumulative_prob += probabilities[i];
+                if (rand_prob <= cumulative_prob)
                 {
-                    valid_path = false;
+                    chosen = i;
                     break;
                 }
+            }
 
-                std::vector<std::pair<Node *, double>> probabilities;
-                double total_prob = 0;
+            ant.length = addDistance(ant.length, neighbours[chosen].second);
+            ant.edges.push_back(first + chosen);
+            current = neighbours[chosen].first;
+            ant.path.push_back(current.index());
+        }
 
-                for (const auto &neighbour : current->getNeighbours())
-                {
-                    double prob = probability(current, neighbour.first);
-                    probabilities.push_back({neighbour.first, prob});
-                    total_prob += prob;
-                }
+        return true;
+    };
 
-                if (total_prob == 0)
-                {
-                    valid_path = false;
-                    break;
-                }
+    AntWalk best;
+    std::vector<Distance> best_lengths_per_iteration = run(pheromones, pool, walk, best);
 
-                std::random_device rd;
-                std::mt19937 gen(rd());
-                std::uniform_real_distribution<> dis(0, total_prob);
+    Way best_way;
+    if (best.valid)
+    {
+        for (uint32_t id : best.path) best_way.nodes.push_back(NodeId(id));
+        best_way.length = best.length;
+    }
 
-                double rand_prob = dis(gen);
-                double cumulative_prob = 0;
-                Node *next = nullptr;
-                size_t edge_weight = 0;
+    return {best_way, best_lengths_per_iteration}; // возвращаем лучший путь и длины на каждой итерации
+}
 
-                for (const auto &p : probabilities)
-                {
-                    cumulative_prob += p.second;
-                    if (rand_prob <= cumulative_prob)
-                    {
-                        next = p.first;
-                        for (const auto &neighbour : current->getNeighbours())
-                        {
-                            if (neighbour.first == next)
-                            {
-                                edge_weight = neighbour.second;
-                                break;
-                            }
-                        }
-                        distance += edge_weight;
-                        break;
-                    }
-                }
+template <class W>
+std::pair<BasicWay<W>, std::vector<DistanceOf<W>>> BasicAntColony<W>::shortestWay(const CsrGraph &csr, uint32_t departure, uint32_t target)
+{
+    return shortestWay(csr, departure, target, defaultPool());
+}
 
-                if (next == nullptr)
-                {
-                    valid_path = false;
-                    break;
-                }
+template <class W>
+std::pair<BasicWay<W>, std::vector<DistanceOf<W>>> BasicAntColony<W>::shortestWay(const CsrGraph &csr, uint32_t departure, uint32_t target, ThreadPool &pool)
+{
+    if (edge_pheromones.size() != csr.edgeCount())
+        edge_pheromones.assign(csr.edgeCount(), 1.0); // начальные феромоны
 
-                current = next;
-            }
+    auto walk = [&](const PheromoneTrail &trail, Xoshiro256 &rng, std::vector<double> &probabilities, AntWalk &ant)
+    {
+        uint32_t current = departure;
+        ant.path.push_back(current);
+
+        while (current != target)
+        {
+            uint32_t first = csr.edgesBegin(current), last = csr.edgesEnd(current);
 
-            if (current == end && valid_path)
+            probabilities.clear();
+            double total_prob = 0;
+            for (uint32_t e = first; e < last; ++e)
             {
-                way.nodes.push_back(end);
-                way.length = distance;
+                double prob = probability(trail, e, csr.weight(e));
+                probabilities.push_back(prob);
+                total_prob += prob;
+            }
+
+            if (total_prob == 0)
+                return false;
 
-                if (best_way.nodes.empty() || way.length < best_way.length)
-                    best_way = way;
+            double rand_prob = rng.uniform() * total_prob;
+            double cumulative_prob = 0;
+            uint32_t chosen = last - 1; // на случай ошибки округления
 
-                updatePheromones(way);
+            for (uint32_t e = first; e < last; ++e)
+            {
+                cumulative_prob += probabilities[e - first];
+                if (rand_prob <= cumulative_prob)
+                {
+                    chosen = e;
+                    break;
+                }
             }
+
+            ant.length = addDistance(ant.length, csr.weight(chosen));
+            ant.edges.push_back(chosen);
+            current = csr.target(chosen);
+            ant.path.push_back(current);
         }
 
-        best_lengths_per_iteration.push_back(best_way.length);
+        return true;
+    };
+
+    AntWalk best;
+    std::vector<Distance> best_lengths_per_iteration = run(edge_pheromones, pool, walk, best);
+
+    Way best_way;
+    if (best.valid)
+    {
+        for (uint32_t v : best.path) best_way.nodes.push_back(csr.nodeId(v));
+        best_way.length = best.length;
     }
 
-    return {best_way, best_lengths_per_iteration}; // возвращаем лучший путь и длины на каждой итерации
+    return {best_way, best_lengths_per_iteration};
 }
 
-const std::map<std::pair<Node*, Node*>, double>& AntColony::getPheromoneLevels() const
-{
-    return pheromones;
-}
+template class BasicAntColony<uint32_t>;
+template class BasicAntColony<uint64_t>;
+template class BasicAntColony<float>;
+template class BasicAntColony<double>;
@@ -0,0 +1,458 @@
+#include "../headers/contraction.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    // Дуги пишутся как есть, поэтому файл для дробных весов помечен отдельно
+    constexpr char magic[8] = {'G', 'R', 'A', 'P', 'H', 'C', 'H', std::is_floating_point_v<Weight> ? 'F' : '2'};
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    struct Link
+    {
+        uint32_t other;
+        Distance weight;
+        uint32_t middle;
+    };
+
+    struct Shortcut
+    {
+        uint32_t from;
+        uint32_t to;
+        Distance weight;
+        uint32_t middle;
+    };
+
+    // Граф на время сжатия: исходные рёбра плюс сокращения. Рёбра сжатого
+    // узла уходят из списков в finished - дальше они не меняются
+    class Contractor
+    {
+        std::vector<std::vector<Link>> out, in;
+        std::vector<Shortcut> finished;
+        std::vector<int> deleted_neighbours;
+        std::vector<Distance> distances; // поиск свидетеля
+        std::vector<uint32_t> touched;
+        size_t witness_limit;
+        size_t estimate_limit; // для оценки приоритета хватает короткого поиска
+
+        void witnessSearch(uint32_t source, uint32_t skip, Distance max_distance, size_t limit)
+        {
+            for (uint32_t v : touched) distances[v] = unreachable;
+            touched.clear();
+
+            std::priority_queue<std::pair<Distance, uint32_t>, std::vector<std::pair<Distance, uint32_t>>, std::greater<>> pq;
+            distances[source] = 0;
+            touched.push_back(source);
+            pq.push({0, source});
+
+            for (size_t settled = 0; !pq.empty() && settled < limit; ++settled)
+            {
+                auto [current_distance, current] = pq.top();
+                pq.pop();
+
+                if (current_distance > distances[current])
+                    continue;
+                if (current_distance > max_distance)
+                    break;
+
+                for (const Link& link : out[current])
+                {
+                    if (link.other == skip)
+                        continue;
+
+                    Distance new_distance = addDistance(current_distance, link.weight);
+                    if (new_distance < distances[link.other])
+                    {
+                        if (distances[link.other] == unreachable) touched.push_back(link.other);
+                        distances[link.other] = new_distance;
+                        pq.push({new_distance, link.other});
+                    }
+                }
+            }
+        }
+
+        static void unlink(std::vector<Link>& links, uint32_t other)
+        {
+            for (size_t i = 0; i < links.size(); ++i)
+            {
+                if (links[i].other == other)
+                {
+                    links[i] = links.back();
+                    links.pop_back();
+                    return;
+                }
+            }
+        }
+
+        static void upsert(std::vector<Link>& links, uint32_t other, Distance weight, uint32_t middle)
+        {
+            for (Link& link : links)
+            {
+                if (link.other == other)
+                {
+                    if (weight < link.weight) link = {other, weight, middle};
+                    return;
+                }
+            }
+            links.push_back({other, weight, middle});
+        }
+    public:
+        Contractor(const Graph& graph, size_t limit)
+            : out(graph.idBound().index()), in(graph.idBound().index()),
+              deleted_neighbours(graph.idBound().index(), 0), distances(graph.idBound().index(), unreachable), witness_limit(limit), estimate_limit(std::min<size_t>(limit, 20))
+        {
+            for (NodeId id : graph.getNodes())
+            {
+                for (const auto& neighbour : graph.node(id)->getNeighbours())
+                {
+                    if (neighbour.first == id)
+                        continue; // петли на кратчайшие пути не влияют
+
+                    out[id.index()].push_back({neighbour.first.index(), Distance(neighbour.second), none});
+                    in[neighbour.first.index()].push_back({id.index(), Distance(neighbour.second), none});
+                }
+            }
+        }
+
+        // Сокращения, без которых сжатие v сломает кратчайшие пути
+        void shortcuts(uint32_t v, std::vector<Shortcut>& result, size_t limit)
+        {
+            result.clear();
+            for (const Link& incoming : in[v])
+            {
+                uint32_t u = incoming.other;
+
+                bool any_out = false;
+                Distance max_out = 0;
+                for (const Link& outgoing : out[v])
+                {
+                    if (outgoing.other == u)
+                        continue;
+                    any_out = true;
+                    max_out = std::max(max_out, outgoing.weight);
+                }
+                if (!any_out)
+                    continue;
+
+                witnessSearch(u, v, addDistance(incoming.weight, max_out), limit);
+
+                for (const Link& outgoing : out[v])
+                {
+                    uint32_t x = outgoing.other;
+                    if (x == u)
+                        continue;
+
+                    Distance via = addDistance(incoming.weight, outgoing.weight);
+                    if (distances[x] > via) result.push_back({u, x, via, v});
+                }
+            }
+        }
+
+        // Разность рёбер плюс число уже сжатых соседей
+        int priority(uint32_t v, std::vector<Shortcut>& buffer)
+        {
+            shortcuts(v, buffer, estimate_limit);
+
+            return int(buffer.size()) - int(in[v].size() + out[v].size()) + deleted_neighbours[v];
+        }
+
+        void contract(uint32_t v, std::vector<Shortcut>& added)
+        {
+            shortcuts(v, added, witness_limit);
+            for (const Shortcut& shortcut : added)
+            {
+                upsert(out[shortcut.from], shortcut.to, shortcut.weight, v);
+                upsert(in[shortcut.to], shortcut.from, shortcut.weight, v);
+            }
+
+            for (const Link& link : out[v])
+            {
+                finished.push_back({v, link.other, link.weight, link.middle});
+                unlink(in[link.other], v);
+                ++deleted_neighbours[link.other];
+            }
+            for (const Link& link : in[v])
+            {
+                finished.push_back({link.other, v, link.weight, link.middle});
+                unlink(out[link.other], v);
+                ++deleted_neighbours[link.other];
+            }
+
+            out[v].clear();
+            in[v].clear();
+            out[v].shrink_to_fit();
+            in[v].shrink_to_fit();
+        }
+
+        void neighbours(uint32_t v, std::vector<uint32_t>& result) const
+        {
+            result.clear();
+            for (const Link& link : in[v]) result.push_back(link.other);
+            for (const Link& link : out[v]) result.push_back(link.other);
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        const std::vector<Shortcut>& arcs() const { return finished; }
+    };
+}
+
+ContractionHierarchy ContractionHierarchy::build(const Graph& graph, size_t witness_limit)
+{
+    ContractionHierarchy hierarchy(graph);
+    uint32_t n = graph.idBound().index();
+    hierarchy.rank.assign(n, 0);
+
+    Contractor contractor(graph, witness_limit);
+    std::vector<Shortcut> buffer;
+
+    std::vector<int> priorities(n);
+    std::priority_queue<std::pair<int, uint32_t>, std::vector<std::pair<int, uint32_t>>, std::greater<>> order;
+    for (uint32_t v = 0; v < n; ++v)
+    {
+        priorities[v] = contractor.priority(v, buffer);
+        order.push({priorities[v], v});
+    }
+
+    // Ленивое обновление: приоритет пересчитывается при извлечении и, если он
+    // стал хуже следующего в очереди, узел откладывается. После сжатия
+    // пересчитываются соседи, устаревшие записи очереди пропускаются
+    uint32_t next_rank = 0;
+    std::vector<char> done(n, 0);
+    std::vector<uint32_t> neighbours;
+    while (!order.empty())
+    {
+        auto [queued, v] = order.top();
+        order.pop();
+
+        if (done[v] || queued != priorities[v])
+            continue;
+
+        priorities[v] = contractor.priority(v, buffer);
+        if (!order.empty() && priorities[v] > order.top().first)
+        {
+            order.push({priorities[v], v});
+            continue;
+        }
+
+        contractor.neighbours(v, neighbours);
+        contractor.contract(v, buffer);
+        done[v] = 1;
+        hierarchy.rank[v] = next_rank++;
+
+        for (uint32_t u : neighbours)
+        {
+            priorities[u] = contractor.priority(u, buffer);
+            order.push({priorities[u], u});
+        }
+    }
+
+    std::vector<Arc> arcs;
+    arcs.reserve(contractor.arcs().size());
+    for (const Shortcut& arc : contractor.arcs()) arcs.push_back({arc.from, arc.to, arc.weight, arc.middle});
+
+    hierarchy.index(arcs);
+    return hierarchy;
+}
+
+void ContractionHierarchy::index(const std::vector<Arc>& arcs)
+{
+    size_t n = rank.size();
+    up_offsets.assign(n + 1, 0);
+    down_offsets.assign(n + 1, 0);
+
+    // Дуга вверх хранится у начала, дуга вниз - у конца: обе части поиска идут вверх
+    for (const Arc& arc : arcs)
+    {
+        if (rank[arc.to] > rank[arc.from]) ++up_offsets[arc.from + 1];
+        else ++down_offsets[arc.to + 1];
+    }
+    for (size_t v = 0; v < n; ++v)
+    {
+        up_offsets[v + 1] += up_offsets[v];
+        down_offsets[v + 1] += down_offsets[v];
+    }
+
+    up_arcs.resize(up_offsets[n]);
+    down_arcs.resize(down_offsets[n]);
+    std::vector<uint32_t> up_fill(up_offsets.begin(), up_offsets.end() - 1);
+    std::vector<uint32_t> down_fill(down_offsets.begin(), down_offsets.end() - 1);
+    for (const Arc& arc : arcs)
+    {
+        if (rank[arc.to] > rank[arc.from]) up_arcs[up_fill[arc.from]++] = arc;
+        else down_arcs[down_fill[arc.to]++] = arc;
+    }
+
+    for (auto& side : distances) side.assign(n, unreachable);
+    for (auto& side : parents) side.assign(n, npos);
+}
+
+size_t ContractionHierarchy::shortcutCount() const
+{
+    size_t count = 0;
+    for (const Arc& arc : up_arcs) count += arc.middle != npos;
+    for (const Arc& arc : down_arcs) count += arc.middle != npos;
+
+    return count;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findArc(uint32_t from, uint32_t to) const
+{
+    if (rank[to] > rank[from])
+    {
+        for (uint32_t i = up_offsets[from]; i < up_offsets[from + 1]; ++i)
+            if (up_arcs[i].to == to) return &up_arcs[i];
+    }
+    else
+    {
+        for (uint32_t i = down_offsets[to]; i < down_offsets[to + 1]; ++i)
+            if (down_arcs[i].from == from) return &down_arcs[i];
+    }
+
+    return nullptr;
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, std::vector<NodeId>& nodes) const
+{
+    const Arc* arc = findArc(from, to);
+    if (arc->middle == npos)
+    {
+        nodes.push_back(NodeId(to));
+        return;
+    }
+
+    unpack(from, arc->middle, nodes);
+    unpack(arc->middle, to, nodes);
+}
+
+Way ContractionHierarchy::shortestWay(std::string departure, std::string target)
+{
+    uint32_t begin = std::get<NodeId>(graph[departure]).index();
+    uint32_t end = std::get<NodeId>(graph[target]).index();
+
+    std::priority_queue<std::pair<Distance, uint32_t>, std::vector<std::pair<Distance, uint32_t>>, std::greater<>> pq[2];
+    distances[0][begin] = 0;
+    distances[1][end] = 0;
+    touched.push_back(begin);
+    touched.push_back(end);
+    pq[0].push({0, begin});
+    pq[1].push({0, end});
+
+    Distance best = unreachable;
+    uint32_t meeting = npos;
+
+    while (!pq[0].empty() || !pq[1].empty())
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            // Сторона останавливается, когда её минимум не меньше лучшего пути
+            if (pq[side].empty())
+                continue;
+            if (pq[side].top().first >= best)
+            {
+                pq[side] = {};
+                continue;
+            }
+
+            auto [current_distance, current] = pq[side].top();
+            pq[side].pop();
+
+            if (current_distance > distances[side][current])
+                continue;
+
+            Distance through = addDistance(current_distance, distances[1 - side][current]);
+            if (through < best)
+            {
+                best = through;
+                meeting = current;
+            }
+
+            const std::vector<uint32_t>& offsets = side == 0 ? up_offsets : down_offsets;
+            const std::vector<Arc>& arcs = side == 0 ? up_arcs : down_arcs;
+            for (uint32_t i = offsets[current]; i < offsets[current + 1]; ++i)
+            {
+                uint32_t next = side == 0 ? arcs[i].to : arcs[i].from;
+                Distance new_distance = addDistance(current_distance, arcs[i].weight);
+
+                if (new_distance < distances[side][next])
+                {
+                    if (distances[0][next] == unreachable && distances[1][next] == unreachable) touched.push_back(next);
+                    distances[side][next] = new_distance;
+                    parents[side][next] = current;
+                    pq[side].push({new_distance, next});
+                }
+            }
+        }
+    }
+
+    Way way;
+    way.length = best;
+    if (meeting != npos)
+    {
+        // Цепочка сокращений от начала до точки встречи и от неё до конца
+        std::vector<uint32_t> chain;
+        for (uint32_t at = meeting; at != npos; at = parents[0][at]) chain.push_back(at);
+        std::reverse(chain.begin(), chain.end());
+        for (uint32_t at = parents[1][meeting]; at != npos; at = parents[1][at]) chain.push_back(at);
+
+        way.nodes.push_back(NodeId(chain.front()));
+        for (size_t i = 0; i + 1 < chain.size(); ++i) unpack(chain[i], chain[i + 1], way.nodes);
+    }
+
+    for (uint32_t v : touched)
+    {
+        distances[0][v] = distances[1][v] = unreachable;
+        parents[0][v] = parents[1][v] = npos;
+    }
+    touched.clear();
+
+    return way;
+}
+
+void ContractionHierarchy::save(const std::string& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) throw std::runtime_error("can't open " + path);
+
+    uint32_t n = uint32_t(rank.size());
+    uint64_t count = up_arcs.size() + down_arcs.size();
+
+    file.write(magic, sizeof(magic));
+    file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+    file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    file.write(reinterpret_cast<const char*>(rank.data()), std::streamsize(n * sizeof(uint32_t)));
+    file.write(reinterpret_cast<const char*>(up_arcs.data()), std::streamsize(up_arcs.size() * sizeof(Arc)));
+    file.write(reinterpret_cast<const char*>(down_arcs.data()), std::streamsize(down_arcs.size() * sizeof(Arc)));
+
+    if (!file) throw std::runtime_error("can't write " + path);
+}
+
+ContractionHierarchy ContractionHierarchy::load(const Graph& graph, const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) throw std::runtime_error("can't open " + path);
+
+    char header[sizeof(magic)];
+    uint32_t n = 0;
+    uint64_t count = 0;
+    file.read(header, sizeof(header));
+    file.read(reinterpret_cast<char*>(&n), sizeof(n));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(header, magic, sizeof(magic)) != 0)
+        throw std::runtime_error("not a contraction hierarchy: " + path);
+    if (n != graph.idBound().index())
+        throw std::runtime_error("contraction hierarchy does not match the graph: " + path);
+
+    ContractionHierarchy hierarchy(graph);
+    hierarchy.rank.resize(n);
+    std::vector<Arc> arcs(count);
+    file.read(reinterpret_cast<char*>(hierarchy.rank.data()), std::streamsize(n * sizeof(uint32_t)));
+    file.read(reinterpret_cast<char*>(arcs.data()), std::streamsize(count * sizeof(Arc)));
+    if (!file) throw std::runtime_error("truncated contraction hierarchy: " + path);
+
+    hierarchy.index(arcs);
+    return hierarchy;
+}
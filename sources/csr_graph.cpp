@@ -0,0 +1,243 @@
+#include "../headers/csr_graph.h"
+#include "../headers/graph.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr char magic[8] = {'G', 'R', 'A', 'P', 'H', 'C', 'S', 'R'};
+    constexpr uint32_t version = 2;
+    // Тип веса в заголовке: размер в байтах, бит 8 - дробный
+    template <class W>
+    constexpr uint32_t weight_kind = uint32_t(sizeof(W)) | (std::is_floating_point_v<W> ? 0x100u : 0u);
+
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertices;
+        uint32_t edges;
+        uint32_t weight_kind;
+        uint64_t name_bytes;
+    };
+
+    // Секции выравниваем на 8 байт, чтобы массивы можно было читать прямо из отображения
+    size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+    struct Layout
+    {
+        size_t offsets, targets, weights, name_offsets, by_name, names, total;
+
+        Layout(uint32_t vertices, uint32_t edges, uint64_t name_bytes, size_t weight_size)
+        {
+            offsets = sizeof(Header);
+            targets = align8(offsets + (size_t(vertices) + 1) * sizeof(uint32_t));
+            weights = align8(targets + size_t(edges) * sizeof(uint32_t));
+            name_offsets = align8(weights + size_t(edges) * weight_size);
+            by_name = name_offsets + (size_t(vertices) + 1) * sizeof(uint64_t);
+            names = align8(by_name + size_t(vertices) * sizeof(uint32_t));
+            total = names + name_bytes;
+        }
+    };
+
+    // Массив границ из count + 1 элементов: с нуля, не убывает и кончается на last
+    template <class T>
+    bool monotonic(const T* offsets, size_t count, T last)
+    {
+        if (offsets[0] != 0 || offsets[count] != last)
+            return false;
+        for (size_t i = 0; i < count; ++i)
+            if (offsets[i] > offsets[i + 1]) return false;
+        return true;
+    }
+
+    bool below(const uint32_t* ids, size_t count, uint32_t bound)
+    {
+        return std::all_of(ids, ids + count, [bound](uint32_t id) { return id < bound; });
+    }
+}
+
+template <class W>
+BasicCsrGraph<W>::BasicCsrGraph(const BasicGraph<W>& graph, bool detached) : name_offsets(nullptr), names(nullptr)
+{
+    // Обход по NodeId даёт детерминированную нумерацию и пропускает удалённые узлы
+    ids.assign(graph.idBound().index(), npos);
+    nodes.reserve(graph.nodeCount());
+    for (NodeId id(0); id < graph.idBound(); ++id)
+    {
+        if (const BasicNode<W>* node = graph.node(id))
+        {
+            ids[id.index()] = uint32_t(nodes.size());
+            nodes.push_back(node);
+        }
+    }
+
+    size_t edge_total = 0;
+    for (const auto* node : nodes) edge_total += node->getNeighbours().size();
+
+    offset_storage.reserve(nodes.size() + 1);
+    target_storage.reserve(edge_total);
+    weight_storage.reserve(edge_total);
+
+    offset_storage.push_back(0);
+    for (const auto* node : nodes)
+    {
+        for (const auto& neighbour : node->getNeighbours())
+        {
+            target_storage.push_back(ids[neighbour.first.index()]);
+            weight_storage.push_back(neighbour.second);
+        }
+        offset_storage.push_back(uint32_t(target_storage.size()));
+    }
+
+    by_name_storage.resize(nodes.size());
+    for (uint32_t v = 0; v < by_name_storage.size(); ++v) by_name_storage[v] = v;
+    std::sort(by_name_storage.begin(), by_name_storage.end(),
+              [this](uint32_t a, uint32_t b) { return nodes[a]->getName() < nodes[b]->getName(); });
+
+    vertices = uint32_t(nodes.size());
+    edges = uint32_t(target_storage.size());
+    offsets = offset_storage.data();
+    targets = target_storage.data();
+    weights = weight_storage.data();
+    by_name = by_name_storage.data();
+
+    if (detached)
+    {
+        name_offset_storage.reserve(nodes.size() + 1);
+        name_offset_storage.push_back(0);
+        for (const auto* node : nodes)
+        {
+            name_storage.insert(name_storage.end(), node->getName().begin(), node->getName().end());
+            name_offset_storage.push_back(name_storage.size());
+        }
+
+        name_offsets = name_offset_storage.data();
+        names = name_storage.data();
+        nodes.clear();
+        nodes.shrink_to_fit();
+    }
+}
+
+template <class W>
+std::string_view BasicCsrGraph<W>::name(uint32_t v) const
+{
+    if (!nodes.empty()) return nodes[v]->getName();
+
+    return std::string_view(names + name_offsets[v], size_t(name_offsets[v + 1] - name_offsets[v]));
+}
+
+template <class W>
+uint32_t BasicCsrGraph<W>::id(NodeId node) const
+{
+    return node.index() < ids.size() ? ids[node.index()] : npos;
+}
+
+template <class W>
+uint32_t BasicCsrGraph<W>::id(std::string_view l) const
+{
+    auto it = std::lower_bound(by_name, by_name + vertices, l,
+                               [this](uint32_t v, std::string_view key) { return name(v) < key; });
+
+    return it != by_name + vertices && name(*it) == l ? *it : npos;
+}
+
+template <class W>
+void BasicCsrGraph<W>::save(const std::string& path) const
+{
+    std::vector<uint64_t> name_table{0};
+    for (uint32_t v = 0; v < vertices; ++v) name_table.push_back(name_table.back() + name(v).size());
+
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.vertices = vertices;
+    header.edges = edges;
+    header.weight_kind = weight_kind<W>;
+    header.name_bytes = name_table.back();
+
+    Layout layout(vertices, edges, header.name_bytes, sizeof(W));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) throw std::runtime_error("can't open " + path);
+
+    auto section = [&file](size_t at, const void* data, size_t bytes)
+    {
+        static const char padding[8] = {};
+        file.write(padding, std::streamsize(at - size_t(file.tellp())));
+        file.write(static_cast<const char*>(data), std::streamsize(bytes));
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    section(layout.offsets, offsets, (size_t(vertices) + 1) * sizeof(uint32_t));
+    section(layout.targets, targets, size_t(edges) * sizeof(uint32_t));
+    section(layout.weights, weights, size_t(edges) * sizeof(W));
+    section(layout.name_offsets, name_table.data(), name_table.size() * sizeof(uint64_t));
+    section(layout.by_name, by_name, size_t(vertices) * sizeof(uint32_t));
+    section(layout.names, nullptr, 0);
+    for (uint32_t v = 0; v < vertices; ++v) file.write(name(v).data(), std::streamsize(name(v).size()));
+
+    if (!file) throw std::runtime_error("can't write " + path);
+}
+
+template <class W>
+BasicCsrGraph<W> BasicCsrGraph<W>::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("can't open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < sizeof(Header))
+    {
+        close(fd);
+        throw std::runtime_error("not a graph snapshot: " + path);
+    }
+
+    size_t size = size_t(info.st_size);
+    // MAP_SHARED: несколько процессов читают одну копию из страничного кэша
+    void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("can't map " + path);
+
+    BasicCsrGraph csr;
+    csr.mapping = std::shared_ptr<const void>(data, [size](const void* p) { munmap(const_cast<void*>(p), size); });
+
+    const char* base = static_cast<const char*>(data);
+    const Header* header = reinterpret_cast<const Header*>(base);
+    if (std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version
+        || header->weight_kind != weight_kind<W>)
+        throw std::runtime_error("unsupported graph snapshot: " + path);
+
+    Layout layout(header->vertices, header->edges, header->name_bytes, sizeof(W));
+    if (header->name_bytes > size || layout.total != size) throw std::runtime_error("truncated graph snapshot: " + path);
+
+    csr.vertices = header->vertices;
+    csr.edges = header->edges;
+    csr.offsets = reinterpret_cast<const uint32_t*>(base + layout.offsets);
+    csr.targets = reinterpret_cast<const uint32_t*>(base + layout.targets);
+    csr.weights = reinterpret_cast<const W*>(base + layout.weights);
+    csr.name_offsets = reinterpret_cast<const uint64_t*>(base + layout.name_offsets);
+    csr.by_name = reinterpret_cast<const uint32_t*>(base + layout.by_name);
+    csr.names = base + layout.names;
+
+    // Запросы индексируют массивы без проверок, поэтому испорченный файл
+    // отсекается здесь, один проход по снимку, а не падение при поиске
+    if (!monotonic(csr.offsets, csr.vertices, csr.edges) || !below(csr.targets, csr.edges, csr.vertices)
+        || !monotonic(csr.name_offsets, csr.vertices, header->name_bytes) || !below(csr.by_name, csr.vertices, csr.vertices))
+        throw std::runtime_error("corrupted graph snapshot: " + path);
+
+    return csr;
+}
+
+template class BasicCsrGraph<uint32_t>;
+template class BasicCsrGraph<uint64_t>;
+template class BasicCsrGraph<float>;
+template class BasicCsrGraph<double>;
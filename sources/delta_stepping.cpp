@@ -0,0 +1,200 @@
+#include "../headers/delta_stepping.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    struct Request
+    {
+        NodeId target;
+        NodeId parent;
+        Distance distance;
+    };
+
+    // Узлы одного потока: кольцо корзин и входящие запросы от каждого потока
+    struct Partition
+    {
+        std::vector<std::vector<NodeId>> buckets;
+        std::vector<NodeId> frontier; // взятые из текущей корзины на этом шаге
+        std::vector<NodeId> settled;  // все узлы, вынутые из текущей корзины
+        std::vector<std::vector<Request>> outbox; // outbox[owner] - запросы к узлам владельца
+        uint64_t next; // ближайшая непустая корзина после текущей
+    };
+
+    Weight maxWeight(const Graph& graph, size_t& edges)
+    {
+        Weight result = 0;
+        edges = 0;
+        for (NodeId id : graph.getNodes())
+        {
+            const Node* node = graph.node(id);
+            edges += node->getNeighbours().size();
+            for (const auto& neighbour : node->getNeighbours()) result = std::max(result, neighbour.second);
+        }
+
+        return result;
+    }
+}
+
+DeltaStepping::DeltaStepping(const Graph& agraph, ThreadPool& apool, Distance adelta)
+    : graph(agraph), pool(apool), delta(adelta)
+{
+    if (delta > 0)
+        return;
+
+    size_t edges = 0;
+    Weight heaviest = maxWeight(graph, edges);
+    double degree = graph.nodeCount() == 0 ? 1.0 : std::max(1.0, double(edges) / double(graph.nodeCount()));
+
+    delta = Distance(double(heaviest) / degree);
+    if (std::is_integral_v<Distance> && delta < 1) delta = 1;
+    if (!(delta > 0)) delta = 1; // граф без рёбер или с нулевыми весами
+}
+
+ShortestPathTree DeltaStepping::shortestPaths(std::string source)
+{
+    NodeId begin = std::get<NodeId>(graph[source]);
+    size_t bound = graph.idBound().index();
+    size_t parts = pool.size();
+
+    ShortestPathTree tree;
+    tree.distances.assign(bound, unreachable);
+    tree.previous.assign(bound, Node::npos);
+
+    // Вес ребра не больше heaviest, поэтому все живые записи лежат
+    // в корзинах [current, current + cycle) и хватает кольца длины cycle
+    size_t edges = 0;
+    Weight heaviest = maxWeight(graph, edges);
+    uint64_t cycle = uint64_t(double(heaviest) / double(delta)) + 3;
+
+    auto bucketOf = [this](Distance distance) { return uint64_t(distance / delta); };
+    // Узлы раздаются блоками по 64 id: соседние элементы массивов пишет один поток
+    auto owner = [parts](NodeId id) { return (id.index() / 64) % parts; };
+
+    // in_bucket[v] - номер корзины + 1, в которой лежит актуальная запись v, или 0;
+    // removed[v] - номер корзины + 1, из которой v уже вынимали. Оба массива
+    // пишет только владелец узла
+    std::vector<uint64_t> in_bucket(bound, 0);
+    std::vector<uint64_t> removed(bound, 0);
+
+    std::vector<Partition> partitions(parts);
+    for (Partition& partition : partitions)
+    {
+        partition.buckets.resize(cycle);
+        partition.outbox.resize(parts);
+    }
+
+    tree.distances[begin.index()] = 0;
+    in_bucket[begin.index()] = 1;
+    partitions[owner(begin)].buckets[0].push_back(begin);
+
+    auto apply = [&](size_t p)
+    {
+        for (Partition& sender : partitions)
+        {
+            for (const Request& request : sender.outbox[p])
+            {
+                size_t target = request.target.index();
+                if (request.distance >= tree.distances[target])
+                    continue;
+
+                tree.distances[target] = request.distance;
+                tree.previous[target] = request.parent;
+
+                uint64_t b = bucketOf(request.distance);
+                if (in_bucket[target] != b + 1)
+                {
+                    in_bucket[target] = b + 1;
+                    partitions[p].buckets[b % cycle].push_back(request.target);
+                }
+            }
+            sender.outbox[p].clear();
+        }
+    };
+
+    // heavy == false - лёгкие рёбра узлов frontier, true - тяжёлые рёбра узлов settled
+    auto relax = [&](size_t p, bool heavy)
+    {
+        Partition& partition = partitions[p];
+        for (NodeId v : heavy ? partition.settled : partition.frontier)
+        {
+            const Node* node = graph.node(v);
+            Distance base = tree.distances[v.index()];
+            for (const auto& neighbour : node->getNeighbours())
+            {
+                if ((neighbour.second > delta) != heavy)
+                    continue;
+
+                NodeId target = neighbour.first;
+                partition.outbox[owner(target)].push_back({target, v, addDistance(base, neighbour.second)});
+            }
+        }
+    };
+
+    uint64_t current = 0;
+    for (;;)
+    {
+        // Лёгкие рёбра могут вернуть узлы в текущую корзину - крутимся, пока она не опустеет
+        for (;;)
+        {
+            pool.parallelFor(parts, [&](size_t p, size_t)
+            {
+                Partition& partition = partitions[p];
+                std::vector<NodeId>& bucket = partition.buckets[current % cycle];
+
+                partition.frontier.clear();
+                for (NodeId v : bucket)
+                {
+                    if (in_bucket[v.index()] != current + 1)
+                        continue; // узел переехал в другую корзину или уже взят
+                    in_bucket[v.index()] = 0;
+                    partition.frontier.push_back(v);
+                    if (removed[v.index()] != current + 1)
+                    {
+                        removed[v.index()] = current + 1;
+                        partition.settled.push_back(v);
+                    }
+                }
+                bucket.clear();
+
+                relax(p, false);
+            });
+
+            bool progress = false;
+            for (const Partition& partition : partitions) progress = progress || !partition.frontier.empty();
+            if (!progress)
+                break;
+
+            pool.parallelFor(parts, [&](size_t p, size_t) { apply(p); });
+        }
+
+        pool.parallelFor(parts, [&](size_t p, size_t) { relax(p, true); });
+        pool.parallelFor(parts, [&](size_t p, size_t)
+        {
+            apply(p);
+
+            Partition& partition = partitions[p];
+            partition.settled.clear();
+            partition.next = 0;
+            for (uint64_t b = current + 1; b < current + cycle; ++b)
+            {
+                if (!partition.buckets[b % cycle].empty())
+                {
+                    partition.next = b;
+                    break;
+                }
+            }
+        });
+
+        uint64_t next = 0;
+        for (const Partition& partition : partitions)
+            if (partition.next != 0 && (next == 0 || partition.next < next)) next = partition.next;
+        if (next == 0)
+            break;
+
+        current = next;
+    }
+
+    return tree;
+}
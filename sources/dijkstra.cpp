@@ -1,54 +1,339 @@
 #include "../headers/dijkstra.h"
 #include "../headers/node.h"
 
-Way Dijkstra::shortestWay(std::string departure, std::string target)
+#include <algorithm>
+#include <memory>
+
+namespace
 {
-    Node* begin = std::get<Node*>(graph[departure]);
-    Node* end = std::get<Node*>(graph[target]);
-    std::map<Node*, int> distances; // Кратчайшие расстояния от начального узла
-    std::map<Node*, Node*> previous; // Предыдущие узлы для восстановления пути
-    std::priority_queue<std::pair<int, Node*>, std::vector<std::pair<int, Node*>>, std::greater<>> pq; // Очередь с приоритетом
+    // Контекст по умолчанию для вызовов без явного контекста - свой у каждого потока
+    template <class Context>
+    Context& threadContext(int side = 0)
+    {
+        thread_local Context contexts[2];
+        return contexts[side];
+    }
 
-    // Инициализация начальных значений
-    for (Node* node : graph.getNodes())
+    // Заполняет row расстояниями до targets и останавливается, как только осели все цели
+    template <class Graph, class Context, class Distance>
+    void searchTargets(const Graph& graph, NodeId source, const std::vector<NodeId>& targets, Context& context, Distance* row)
     {
-        distances[node] = std::numeric_limits<int>::max();
-        previous[node] = nullptr;
+        context.reset(graph.idBound());
+
+        size_t remaining = 0;
+        for (NodeId target : targets)
+        {
+            if (!context.marked(target))
+            {
+                context.mark(target);
+                ++remaining;
+            }
+        }
+
+        context.set(source, 0, Node::npos);
+        context.push(0, source);
+
+        while (!context.empty() && remaining > 0)
+        {
+            auto [current_distance, current] = context.pop();
+
+            if (current_distance > context.distance(current))
+                continue;
+            if (context.marked(current))
+            {
+                context.unmark(current);
+                --remaining;
+            }
+
+            for (const auto& neighbour : graph.node(current)->getNeighbours())
+            {
+                Distance new_distance = addDistance(current_distance, neighbour.second);
+                if (new_distance < context.distance(neighbour.first))
+                {
+                    context.set(neighbour.first, new_distance, current);
+                    context.push(new_distance, neighbour.first);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < targets.size(); ++i) row[i] = context.distance(targets[i]);
     }
-    distances[begin] = 0;
-    pq.push({0, begin});
 
-    while (!pq.empty())
+    template <class Graph>
+    std::vector<NodeId> resolve(const Graph& graph, const std::vector<std::string>& names)
+    {
+        std::vector<NodeId> nodes;
+        nodes.reserve(names.size());
+        for (const std::string& name : names) nodes.push_back(std::get<NodeId>(graph[name]));
+
+        return nodes;
+    }
+}
+
+template <template <class> class Queue, class W>
+BasicWay<W> BasicDijkstra<Queue, W>::shortestWay(std::string departure, std::string target)
+{
+    return shortestWay(departure, target, threadContext<Context>());
+}
+
+template <template <class> class Queue, class W>
+BasicWay<W> BasicDijkstra<Queue, W>::shortestWay(std::string departure, std::string target, Context& context)
+{
+    NodeId begin = std::get<NodeId>(graph[departure]);
+    NodeId end = std::get<NodeId>(graph[target]);
+
+    // Сброс контекста - O(1), массивы не заполняются заново для всех узлов
+    context.reset(graph.idBound());
+    context.set(begin, 0, Node::npos);
+    context.push(0, begin);
+
+    while (!context.empty())
     {
-        Node* current = pq.top().second;
-        int current_distance = pq.top().first;
-        pq.pop();
+        auto [current_distance, current] = context.pop();
 
         if (current == end)
             break; // Если достигли конечного узла, можно завершать
+        if (current_distance > context.distance(current))
+            continue; // Устаревшая запись в очереди
 
         // Обходим всех соседей
-        for (const auto& neighbour : current->getNeighbours())
+        for (const auto& neighbour : graph.node(current)->getNeighbours())
         {
-            Node* next = neighbour.first;
-            int weight = int(neighbour.second);
-            int new_distance = current_distance + weight;
+            NodeId next = neighbour.first;
+            Distance new_distance = addDistance(current_distance, neighbour.second);
 
             // Обновляем расстояние, если нашли более короткий путь
-            if (new_distance < distances[next])
+            if (new_distance < context.distance(next))
             {
-                distances[next] = new_distance;
-                previous[next] = current;
-                pq.push({new_distance, next});
+                context.set(next, new_distance, current);
+                context.push(new_distance, next);
             }
         }
     }
 
     // Восстанавливаем путь
     Way way;
-    way.length = distances[end];
-    for (Node* at = end; at != nullptr; at = previous[at]) way.nodes.push_back(at);
+    way.length = context.distance(end);
+    for (NodeId at = end; at != Node::npos; at = context.parent(at)) way.nodes.push_back(at);
+    std::reverse(way.nodes.begin(), way.nodes.end());
+
+    return way;
+}
+
+template <template <class> class Queue, class W>
+std::vector<DistanceOf<W>> BasicDijkstra<Queue, W>::oneToMany(std::string source, const std::vector<std::string>& targets)
+{
+    return oneToMany(source, targets, threadContext<Context>());
+}
+
+template <template <class> class Queue, class W>
+std::vector<DistanceOf<W>> BasicDijkstra<Queue, W>::oneToMany(std::string source, const std::vector<std::string>& targets, Context& context)
+{
+    std::vector<Distance> row(targets.size());
+    searchTargets(graph, std::get<NodeId>(graph[source]), resolve(graph, targets), context, row.data());
+
+    return row;
+}
+
+template <template <class> class Queue, class W>
+void BasicDijkstra<Queue, W>::distancesFrom(NodeId source, Context& context, Distance* row)
+{
+    context.reset(graph.idBound());
+    context.set(source, 0, Node::npos);
+    context.push(0, source);
+
+    while (!context.empty())
+    {
+        auto [current_distance, current] = context.pop();
+        if (current_distance > context.distance(current))
+            continue;
+
+        for (const auto& neighbour : graph.node(current)->getNeighbours())
+        {
+            Distance new_distance = addDistance(current_distance, neighbour.second);
+            if (new_distance < context.distance(neighbour.first))
+            {
+                context.set(neighbour.first, new_distance, current);
+                context.push(new_distance, neighbour.first);
+            }
+        }
+    }
+
+    for (NodeId id(0); id < graph.idBound(); ++id) row[id.index()] = context.distance(id);
+}
+
+template <template <class> class Queue, class W>
+std::vector<DistanceOf<W>> BasicDijkstra<Queue, W>::manyToMany(const std::vector<std::string>& sources, const std::vector<std::string>& targets, ThreadPool& pool)
+{
+    std::vector<NodeId> source_nodes = resolve(graph, sources);
+    std::vector<NodeId> target_nodes = resolve(graph, targets);
+    std::vector<Distance> matrix(sources.size() * targets.size());
+
+    // По контексту на исполнителя пула, создаются при первой задаче
+    std::vector<std::unique_ptr<Context>> contexts(pool.size());
+    pool.parallelFor(sources.size(), [&](size_t i, size_t slot)
+    {
+        if (!contexts[slot]) contexts[slot] = std::make_unique<Context>();
+        searchTargets(graph, source_nodes[i], target_nodes, *contexts[slot], matrix.data() + i * targets.size());
+    });
+
+    return matrix;
+}
+
+template <template <class> class Queue, class W>
+std::vector<DistanceOf<W>> BasicDijkstra<Queue, W>::manyToMany(const std::vector<std::string>& sources, const std::vector<std::string>& targets)
+{
+    if (!own_pool) own_pool = std::make_unique<ThreadPool>();
+    return manyToMany(sources, targets, *own_pool);
+}
+
+template <template <class> class Queue, class W>
+BasicWay<W> BasicDijkstra<Queue, W>::bidirectionalWay(std::string departure, std::string target)
+{
+    return bidirectionalWay(departure, target, threadContext<Context>(0), threadContext<Context>(1));
+}
+
+template <template <class> class Queue, class W>
+BasicWay<W> BasicDijkstra<Queue, W>::bidirectionalWay(std::string departure, std::string target, Context& forward, Context& backward)
+{
+    NodeId begin = std::get<NodeId>(graph[departure]);
+    NodeId end = std::get<NodeId>(graph[target]);
+
+    // Индекс 0 - прямой поиск от begin, 1 - обратный от end
+    Context* sides[2] = {&forward, &backward};
+    forward.reset(graph.idBound());
+    backward.reset(graph.idBound());
+
+    forward.set(begin, 0, Node::npos);
+    backward.set(end, 0, Node::npos);
+    forward.push(0, begin);
+    backward.push(0, end);
+
+    Distance best = begin == end ? 0 : unreachableOf<Distance>; // лучшая найденная длина через точку встречи
+    NodeId meeting = begin == end ? begin : Node::npos;
+
+    while (!forward.empty() && !backward.empty())
+    {
+        // Дальше обе границы только удаляются - путь короче best уже не найти
+        if (addDistance(forward.top().first, backward.top().first) >= best)
+            break;
+
+        int side = forward.size() <= backward.size() ? 0 : 1; // расширяем меньшую границу
+        Context& context = *sides[side];
+        Context& other_context = *sides[1 - side];
+        auto [current_distance, current] = context.pop();
+
+        if (current_distance > context.distance(current))
+            continue;
+
+        const auto* node = graph.node(current);
+        const auto& edges = side == 0 ? node->getNeighbours() : node->getInbound();
+        for (const auto& neighbour : edges)
+        {
+            NodeId next = neighbour.first;
+            Distance new_distance = addDistance(current_distance, neighbour.second);
+
+            if (new_distance < context.distance(next))
+            {
+                context.set(next, new_distance, current);
+                context.push(new_distance, next);
+
+                Distance through = addDistance(new_distance, other_context.distance(next));
+                if (through < best)
+                {
+                    best = through;
+                    meeting = next;
+                }
+            }
+        }
+    }
+
+    Way way;
+    way.length = best;
+    if (meeting == Node::npos)
+        return way;
+
+    for (NodeId at = meeting; at != Node::npos; at = forward.parent(at)) way.nodes.push_back(at);
     std::reverse(way.nodes.begin(), way.nodes.end());
+    for (NodeId at = backward.parent(meeting); at != Node::npos; at = backward.parent(at)) way.nodes.push_back(at);
 
     return way;
 }
+
+template <template <class> class Queue, class W>
+BasicWay<W> BasicDijkstra<Queue, W>::shortestWay(const CsrGraph& csr, uint32_t departure, uint32_t target)
+{
+    CsrWay path = shortestPath(csr, departure, target);
+
+    Way way;
+    way.length = path.length;
+    for (uint32_t v : path.vertices) way.nodes.push_back(csr.nodeId(v));
+
+    return way;
+}
+
+template <template <class> class Queue, class W>
+BasicCsrWay<W> BasicDijkstra<Queue, W>::shortestPath(const CsrGraph& csr, uint32_t departure, uint32_t target)
+{
+    // Плотные массивы по id вершины вместо std::map
+    std::vector<Distance> distances(csr.vertexCount(), unreachableOf<Distance>);
+    std::vector<uint32_t> previous(csr.vertexCount(), CsrGraph::npos);
+    Queue<Distance> pq;
+    pq.reset(NodeId(csr.vertexCount()));
+
+    distances[departure] = 0;
+    pq.push(0, NodeId(departure));
+
+    while (!pq.empty())
+    {
+        auto [current_distance, popped] = pq.pop();
+        uint32_t current = popped.index(); // очереди хранят NodeId, здесь это вершина CSR
+
+        if (current == target)
+            break;
+        if (current_distance > distances[current])
+            continue; // устаревшая запись в очереди
+
+        for (uint32_t e = csr.edgesBegin(current); e < csr.edgesEnd(current); ++e)
+        {
+            uint32_t next = csr.target(e);
+            Distance new_distance = addDistance(current_distance, csr.weight(e));
+
+            if (new_distance < distances[next])
+            {
+                distances[next] = new_distance;
+                previous[next] = current;
+                pq.push(new_distance, NodeId(next));
+            }
+        }
+    }
+
+    CsrWay way;
+    way.length = distances[target];
+    if (way.length == unreachableOf<Distance>)
+        return way;
+
+    for (uint32_t at = target; at != CsrGraph::npos; at = previous[at]) way.vertices.push_back(at);
+    std::reverse(way.vertices.begin(), way.vertices.end());
+
+    return way;
+}
+
+template class BasicDijkstra<BinaryHeap, uint32_t>;
+template class BasicDijkstra<RadixHeap, uint32_t>;
+template class BasicDijkstra<DialQueue, uint32_t>;
+template class BasicDijkstra<QuaternaryHeap, uint32_t>;
+
+template class BasicDijkstra<BinaryHeap, uint64_t>;
+template class BasicDijkstra<RadixHeap, uint64_t>;
+template class BasicDijkstra<DialQueue, uint64_t>;
+template class BasicDijkstra<QuaternaryHeap, uint64_t>;
+
+// Очередь Дайала для дробных весов не годится
+template class BasicDijkstra<BinaryHeap, float>;
+template class BasicDijkstra<RadixHeap, float>;
+template class BasicDijkstra<QuaternaryHeap, float>;
+
+template class BasicDijkstra<BinaryHeap, double>;
+template class BasicDijkstra<RadixHeap, double>;
+template class BasicDijkstra<QuaternaryHeap, double>;
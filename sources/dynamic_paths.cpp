@@ -0,0 +1,214 @@
+#include "../headers/dynamic_paths.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Текущий вес ребра from -> to, если оно есть
+    bool findWeight(const Node* from, NodeId to, Weight& weight)
+    {
+        const auto& edges = from->getNeighbours();
+        auto it = std::lower_bound(edges.begin(), edges.end(), to,
+                                   [](const std::pair<NodeId, Weight>& edge, NodeId id) { return edge.first < id; });
+        if (it == edges.end() || it->first != to)
+            return false;
+
+        weight = it->second;
+        return true;
+    }
+}
+
+DynamicShortestPaths::DynamicShortestPaths(Graph& agraph, std::string asource)
+    : graph(agraph), source(std::get<NodeId>(agraph[asource])), repaired(0)
+{
+    grow();
+    tree.distances[source.index()] = 0;
+    pq.push({0, source});
+    propagate();
+}
+
+void DynamicShortestPaths::grow()
+{
+    size_t bound = graph.idBound().index();
+    if (tree.distances.size() >= bound)
+        return;
+
+    tree.distances.resize(bound, unreachable);
+    tree.previous.resize(bound, Node::npos);
+    marked.resize(bound, 0);
+}
+
+// Дейкстра от узлов в очереди; трогает только узлы, чьё расстояние улучшается
+void DynamicShortestPaths::propagate()
+{
+    while (!pq.empty())
+    {
+        auto [current_distance, current] = pq.top();
+        pq.pop();
+
+        if (current_distance > tree.distances[current.index()])
+            continue;
+        ++repaired;
+
+        for (const auto& neighbour : graph.node(current)->getNeighbours())
+        {
+            NodeId next = neighbour.first;
+            Distance new_distance = addDistance(current_distance, neighbour.second);
+            if (new_distance < tree.distances[next.index()])
+            {
+                tree.distances[next.index()] = new_distance;
+                tree.previous[next.index()] = current;
+                pq.push({new_distance, next});
+            }
+        }
+    }
+}
+
+void DynamicShortestPaths::lower(NodeId from, NodeId to, Weight weight)
+{
+    Distance candidate = addDistance(tree.distances[from.index()], weight);
+    if (candidate >= tree.distances[to.index()])
+        return;
+
+    tree.distances[to.index()] = candidate;
+    tree.previous[to.index()] = from;
+    pq.push({candidate, to});
+    propagate();
+}
+
+// Поддерево root по указателям previous: только эти узлы могли удлиниться
+void DynamicShortestPaths::collect(NodeId root)
+{
+    affected.clear();
+    affected.push_back(root);
+    marked[root.index()] = 1;
+
+    for (size_t i = 0; i < affected.size(); ++i)
+    {
+        for (const auto& neighbour : graph.node(affected[i])->getNeighbours())
+        {
+            NodeId child = neighbour.first;
+            if (!marked[child.index()] && tree.previous[child.index()] == affected[i])
+            {
+                marked[child.index()] = 1;
+                affected.push_back(child);
+            }
+        }
+    }
+}
+
+// Начальная оценка узла поддерева - лучший вход от узла вне поддерева,
+// дальше Дейкстра раздаёт расстояния внутри него
+void DynamicShortestPaths::recompute()
+{
+    for (NodeId id : affected)
+    {
+        tree.distances[id.index()] = unreachable;
+        tree.previous[id.index()] = Node::npos;
+    }
+
+    for (NodeId id : affected)
+    {
+        const Node* node = graph.node(id);
+        if (node == nullptr)
+            continue; // узел удалён вместе с рёбрами
+
+        if (id == source)
+        {
+            tree.distances[id.index()] = 0;
+        }
+        else
+        {
+            for (const auto& incoming : node->getInbound())
+            {
+                NodeId from = incoming.first;
+                if (marked[from.index()])
+                    continue;
+
+                Distance candidate = addDistance(tree.distances[from.index()], incoming.second);
+                if (candidate < tree.distances[id.index()])
+                {
+                    tree.distances[id.index()] = candidate;
+                    tree.previous[id.index()] = from;
+                }
+            }
+        }
+
+        if (tree.distances[id.index()] != unreachable) pq.push({tree.distances[id.index()], id});
+    }
+
+    for (NodeId id : affected) marked[id.index()] = 0;
+    propagate();
+}
+
+void DynamicShortestPaths::setEdge(NodeId from, NodeId to, Weight weight)
+{
+    repaired = 0;
+    if (!graph.node(from) || !graph.node(to))
+        return;
+
+    grow();
+
+    Weight old = 0;
+    bool existed = findWeight(graph.node(from), to, old);
+    graph.addEdge(from, to, weight, DuplicatePolicy::KeepLast);
+
+    if (!existed || weight < old)
+    {
+        lower(from, to, weight);
+    }
+    else if (weight > old && tree.previous[to.index()] == from)
+    {
+        // Удлинилось ребро дерева: под ним всё могло измениться
+        collect(to);
+        recompute();
+    }
+}
+
+void DynamicShortestPaths::removeEdge(NodeId from, NodeId to)
+{
+    repaired = 0;
+    if (!graph.node(from) || !graph.node(to))
+        return;
+
+    grow();
+
+    bool in_tree = tree.previous[to.index()] == from;
+    graph.removeEdge(from, to);
+
+    if (in_tree)
+    {
+        collect(to);
+        recompute();
+    }
+}
+
+void DynamicShortestPaths::removeNode(NodeId id)
+{
+    // Удалённый или несуществующий узел: граф не меняется, дерево тоже
+    repaired = 0;
+    if (!graph.node(id))
+        return;
+
+    grow();
+
+    // Поддерево собирается до удаления, пока у узла есть исходящие рёбра
+    collect(id);
+    graph.removeNode(id);
+    recompute();
+}
+
+Way DynamicShortestPaths::shortestWay(std::string target) const
+{
+    NodeId end = std::get<NodeId>(graph[target]);
+
+    Way way;
+    way.length = distance(end);
+    if (way.length == unreachable)
+        return way;
+
+    for (NodeId at = end; at != Node::npos; at = tree.previous[at.index()]) way.nodes.push_back(at);
+    std::reverse(way.nodes.begin(), way.nodes.end());
+
+    return way;
+}
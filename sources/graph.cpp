@@ -1,47 +1,237 @@
 #include "../headers/graph.h"
+#include "../headers/csr_graph.h"
+#include "../headers/graph_observer.h"
+#include "../headers/loader.h"
 
-void Graph::removeNode(Node* node)
+#include <algorithm>
+
+// Событие для наблюдателя графа; с -DGRAPH_NO_EVENTS не компилируется вовсе
+#ifdef GRAPH_NO_EVENTS
+#define GRAPH_NOTIFY(call)
+#else
+#define GRAPH_NOTIFY(call) do { if (observer) observer->call; } while (0)
+#endif
+
+template <class W>
+NodeId BasicGraph<W>::addNode(std::string_view name)
 {
-    for (auto it = nodes.begin(); it != nodes.end(); ++it) (*it)->removeNeighbour(node);
-    
-    if (nodes.find(node) != nodes.end()) {
-        nodes.erase(node);
-        std::cout << "removed node " << node->getName() << '\n' << std::endl;
-        delete node;
+    auto found = index.find(name);
+    if (found != index.end()) return found->second->id;
+
+    Node* node = new (pool.allocate(sizeof(Node), alignof(Node))) Node(std::string(name), &pool);
+    node->id = NodeId(uint32_t(byId.size()));
+
+    byId.push_back(node);
+    ++count;
+    index.emplace(node->getName(), node);
+    ++version;
+    GRAPH_NOTIFY(nodeAdded(*node));
+
+    return node->id;
+}
+
+template <class W>
+void BasicGraph<W>::addEdges(std::vector<Edge> edges, DuplicatePolicy policy)
+{
+    // Рёбра удалённых и несуществующих узлов пропускаются, как в removeEdge
+    edges.erase(std::remove_if(edges.begin(), edges.end(), [this](const Edge& edge)
+    {
+        return !node(edge.departure) || !node(edge.target);
+    }), edges.end());
+
+    // stable_sort сохраняет порядок повторов внутри пачки - это нужно для KeepLast
+    std::stable_sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b)
+    {
+        return a.departure != b.departure ? a.departure < b.departure : a.target < b.target;
+    });
+
+    std::vector<std::pair<NodeId, W>> batch;
+    std::vector<Edge> reversed; // (куда, откуда, итоговый вес) - для входящих списков
+    reversed.reserve(edges.size());
+
+    for (size_t i = 0; i < edges.size(); )
+    {
+        NodeId departure = edges[i].departure;
+        batch.clear();
+
+        for (; i < edges.size() && edges[i].departure == departure; ++i)
+        {
+            if (!batch.empty() && batch.back().first == edges[i].target)
+                batch.back().second = combineWeights(batch.back().second, edges[i].weight, policy);
+            else
+                batch.emplace_back(edges[i].target, edges[i].weight);
+        }
+
+        Node::merge(byId[departure.index()]->neighbours, batch, policy);
+        for (const auto& edge : batch)
+        {
+            reversed.push_back({edge.first, departure, edge.second});
+            GRAPH_NOTIFY(edgeAdded(*byId[departure.index()], *byId[edge.first.index()], edge.second));
+        }
     }
+
+    std::sort(reversed.begin(), reversed.end(), [](const Edge& a, const Edge& b)
+    {
+        return a.departure != b.departure ? a.departure < b.departure : a.target < b.target;
+    });
+
+    for (size_t i = 0; i < reversed.size(); )
+    {
+        NodeId target = reversed[i].departure;
+        batch.clear();
+
+        for (; i < reversed.size() && reversed[i].departure == target; ++i)
+            batch.emplace_back(reversed[i].target, reversed[i].weight);
+
+        Node::merge(byId[target.index()]->inbound, batch, DuplicatePolicy::KeepLast);
+    }
+
+    ++version;
 }
 
-std::variant<Node*, std::monostate> Graph::operator[](const std::string l) const
+template <class W>
+void BasicGraph<W>::load(const EdgeList& list)
 {
-    for (auto it = nodes.begin(); it != nodes.end(); ++it) if ((*it)->getName() == l) return *it;
-    
-    return std::monostate{};
+    std::vector<Edge> edges;
+    edges.reserve(list.getEdges().size());
+    for (const auto& edge : list.getEdges())
+    {
+        NodeId begin = addNode(edge.departure);
+        edges.push_back({begin, addNode(edge.target), edge.weight});
+    }
+
+    addEdges(std::move(edges));
 }
 
-Graph::~Graph()
+template <class W>
+void BasicGraph<W>::addEdge(NodeId begin, NodeId end, W weight, DuplicatePolicy policy)
 {
-    for (auto it = nodes.begin(); it != nodes.end(); ++it)
+    if (!node(begin) || !node(end))
+        return;
+
+    Node* from = byId[begin.index()];
+    Node* to = byId[end.index()];
+    if (W* old = Node::find(from->neighbours, end)) weight = combineWeights(*old, weight, policy);
+
+    Node::upsert(from->neighbours, end, weight);
+    Node::upsert(to->inbound, begin, weight);
+    ++version;
+    GRAPH_NOTIFY(edgeAdded(*from, *to, weight));
+}
+
+template <class W>
+void BasicGraph<W>::removeEdge(NodeId begin, NodeId end)
+{
+    if (!node(begin) || !node(end) || !Node::erase(byId[begin.index()]->neighbours, end))
+        return;
+
+    Node::erase(byId[end.index()]->inbound, begin);
+    ++version;
+    GRAPH_NOTIFY(edgeRemoved(*byId[begin.index()], *byId[end.index()]));
+}
+
+template <class W>
+void BasicGraph<W>::removeNode(NodeId id)
+{
+    Node* node = id.index() < byId.size() ? byId[id.index()] : nullptr;
+    if (!node)
+        return;
+
+    // Входящие рёбра известны по inbound, поэтому обходить весь граф не нужно
+    for (const auto& incoming : node->inbound)
     {
-        (*it)->clearNeighbours();
-        delete *it;
+        if (incoming.first == id)
+            continue; // петля уйдёт вместе с исходящими
+        Node::erase(byId[incoming.first.index()]->neighbours, id);
+        GRAPH_NOTIFY(edgeRemoved(*byId[incoming.first.index()], *node));
     }
-    
-    nodes.clear();
+    // Узел уходит из входящих списков своих соседей
+    for (const auto& outgoing : node->neighbours)
+    {
+        GRAPH_NOTIFY(edgeRemoved(*node, *byId[outgoing.first.index()]));
+        Node::erase(byId[outgoing.first.index()]->inbound, id);
+    }
+    node->neighbours.clear();
+    node->inbound.clear();
+    byId[id.index()] = nullptr;
+    --count;
+
+    auto indexed = index.find(node->getName());
+    if (indexed != index.end() && indexed->second == node) index.erase(indexed);
+
+    GRAPH_NOTIFY(nodeRemoved(*node));
+    node->~Node();
+    pool.deallocate(node, sizeof(Node), alignof(Node));
+    ++version;
+}
+
+template <class W>
+std::vector<NodeId> BasicGraph<W>::getNodes() const
+{
+    std::vector<NodeId> ids;
+    ids.reserve(count);
+    for (const Node* node : byId)
+        if (node) ids.push_back(node->id);
+
+    return ids;
+}
+
+template <class W>
+std::variant<NodeId, std::monostate> BasicGraph<W>::id(std::string_view l) const
+{
+    auto it = index.find(l);
+    if (it != index.end()) return it->second->id;
+
+    return std::monostate{};
+}
+
+template <class W>
+BasicCsrGraph<W> BasicGraph<W>::freeze() const
+{
+    return CsrGraph(*this);
+}
+
+template <class W>
+BasicCsrGraph<W> BasicGraph<W>::detach() const
+{
+    return CsrGraph(*this, true);
+}
+
+template <class W>
+void BasicGraph<W>::save(const std::string& path) const
+{
+    freeze().save(path);
+}
+
+template <class W>
+BasicGraph<W>::~BasicGraph()
+{
+    // Память узлов не возвращаем по одному: пул отдаёт свои блоки целиком
+    for (Node* node : byId)
+        if (node) node->~Node();
     // std::cout << "the graph is destroyed" << std::endl;
 }
 
-void Graph::show() const
+template <class W>
+void BasicGraph<W>::show() const
 {
     std::cout << "Graph:\n" << std::endl;
 
-    for (auto it = nodes.begin(); it != nodes.end(); ++it) {
-        std::cout << (*it)->getName() << '\t';
+    for (const Node* node : byId) {
+        if (!node)
+            continue;
+        std::cout << node->getName() << '\t';
 
-        for (auto neighIt = (*it)->getNeighbours().begin(); neighIt != (*it)->getNeighbours().end(); ++neighIt)
-            std::cout << neighIt->first->getName() << '-' << neighIt->second << ' ';
+        for (auto neighIt = node->getNeighbours().begin(); neighIt != node->getNeighbours().end(); ++neighIt)
+            std::cout << byId[neighIt->first.index()]->getName() << '-' << neighIt->second << ' ';
         
         std::cout << '\n' << std::endl;
     }
     
     std::cout << "----------------------------------------------------------------------\n" << std::endl;
 }
+
+template class BasicGraph<uint32_t>;
+template class BasicGraph<uint64_t>;
+template class BasicGraph<float>;
+template class BasicGraph<double>;
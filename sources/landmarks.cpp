@@ -0,0 +1,101 @@
+#include "../headers/landmarks.h"
+
+#include <algorithm>
+
+std::vector<Distance> Landmarks::distancesFrom(const Graph& graph, NodeId source, bool reverse)
+{
+    std::vector<Distance> distances(graph.idBound().index(), unreachable);
+    std::priority_queue<std::pair<Distance, NodeId>, std::vector<std::pair<Distance, NodeId>>, std::greater<>> pq;
+
+    distances[source.index()] = 0;
+    pq.push({0, source});
+
+    while (!pq.empty())
+    {
+        auto [current_distance, current] = pq.top();
+        pq.pop();
+
+        if (current_distance > distances[current.index()])
+            continue;
+
+        // Обратный поиск идёт по входящим рёбрам и даёт расстояния до source
+        const Node* node = graph.node(current);
+        for (const auto& neighbour : reverse ? node->getInbound() : node->getNeighbours())
+        {
+            Distance new_distance = addDistance(current_distance, neighbour.second);
+            if (new_distance < distances[neighbour.first.index()])
+            {
+                distances[neighbour.first.index()] = new_distance;
+                pq.push({new_distance, neighbour.first});
+            }
+        }
+    }
+
+    return distances;
+}
+
+Landmarks::Landmarks(const Graph& graph, size_t landmark_count)
+    : count(std::min(landmark_count, graph.nodeCount()))
+{
+    size_t bound = graph.idBound().index();
+    from.assign(bound * count, unreachable);
+    to.assign(bound * count, unreachable);
+
+    // closest[v] - расстояние от ближайшего уже выбранного ориентира до v
+    std::vector<Distance> closest(bound, unreachable);
+    std::vector<NodeId> nodes = graph.getNodes();
+    std::vector<Distance> seed = nodes.empty() ? std::vector<Distance>() : distancesFrom(graph, nodes.front(), false);
+
+    for (size_t l = 0; l < count; ++l)
+    {
+        // Сначала узлы, до которых ни один ориентир не дотягивается, затем самые дальние
+        const std::vector<Distance>& score = l == 0 ? seed : closest;
+        NodeId landmark = Node::npos;
+        Distance best = 0;
+        for (NodeId id : nodes)
+        {
+            if (std::find(chosen.begin(), chosen.end(), id) != chosen.end())
+                continue;
+            if (landmark == Node::npos || score[id.index()] > best)
+            {
+                best = score[id.index()];
+                landmark = id;
+            }
+        }
+
+        chosen.push_back(landmark);
+        std::vector<Distance> forward = distancesFrom(graph, landmark, false);
+        std::vector<Distance> backward = distancesFrom(graph, landmark, true);
+
+        for (size_t v = 0; v < bound; ++v)
+        {
+            from[v * count + l] = forward[v];
+            to[v * count + l] = backward[v];
+            closest[v] = std::min(closest[v], forward[v]);
+        }
+    }
+}
+
+Distance Landmarks::lowerBound(NodeId node, NodeId target) const
+{
+    if (count == 0)
+        return 0;
+
+    const Distance* from_node = &from[size_t(node.index()) * count];
+    const Distance* from_target = &from[size_t(target.index()) * count];
+    const Distance* to_node = &to[size_t(node.index()) * count];
+    const Distance* to_target = &to[size_t(target.index()) * count];
+
+    Distance bound = 0;
+    for (size_t l = 0; l < count; ++l)
+    {
+        // d(L, t) <= d(L, v) + d(v, t) и d(v, L) <= d(v, t) + d(t, L)
+        // расстояния без знака, поэтому разность берём только положительную
+        if (from_target[l] != unreachable && from_node[l] < from_target[l])
+            bound = std::max(bound, from_target[l] - from_node[l]);
+        if (to_node[l] != unreachable && to_target[l] < to_node[l])
+            bound = std::max(bound, to_node[l] - to_target[l]);
+    }
+
+    return bound;
+}
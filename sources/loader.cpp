@@ -0,0 +1,120 @@
+#include "../headers/loader.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr size_t min_chunk = 1 << 20; // мелкие файлы не стоит делить между потоками
+
+    bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    // Следующее слово строки; пустое, если строка закончилась
+    std::string_view token(const char*& it, const char* end)
+    {
+        while (it != end && isSpace(*it)) ++it;
+        const char* begin = it;
+        while (it != end && *it != '\n' && !isSpace(*it)) ++it;
+        return std::string_view(begin, size_t(it - begin));
+    }
+
+    // Целые без знака from_chars уже не пропускает отрицательными, дробные проверяем сами (и NaN)
+    template <class T>
+    bool nonNegative(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>) return value >= 0;
+        else return true;
+    }
+}
+
+template <class W>
+BasicEdgeList<W>::BasicEdgeList(const std::string& path, unsigned threads) : data(nullptr), size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("can't open " + path);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("can't stat " + path);
+    }
+
+    size = size_t(info.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // отображение остаётся действительным и без дескриптора
+    if (mapping == MAP_FAILED) throw std::runtime_error("can't map " + path);
+
+    data = static_cast<const char*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    // Границы кусков сдвигаем на начало следующей строки
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(threads, size / min_chunk + 1));
+    std::vector<const char*> bounds{data};
+    for (size_t i = 1; i < chunks; ++i)
+    {
+        const char* bound = std::max(bounds.back(), data + size * i / chunks);
+        const char* newline = static_cast<const char*>(memchr(bound, '\n', size_t(data + size - bound)));
+        bounds.push_back(newline ? newline + 1 : data + size);
+    }
+    bounds.push_back(data + size);
+
+    std::vector<std::vector<BasicEdgeRecord<W>>> parts(chunks);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < chunks; ++i)
+        workers.emplace_back(parse, bounds[i], bounds[i + 1], std::ref(parts[i]));
+    parse(bounds[0], bounds[1], parts[0]);
+    for (auto& worker : workers) worker.join();
+
+    // Склеиваем куски в исходном порядке строк
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    edges.reserve(total);
+    for (const auto& part : parts) edges.insert(edges.end(), part.begin(), part.end());
+}
+
+template <class W>
+BasicEdgeList<W>::~BasicEdgeList()
+{
+    if (data) munmap(const_cast<char*>(data), size);
+}
+
+template <class W>
+void BasicEdgeList<W>::parse(const char* begin, const char* end, std::vector<BasicEdgeRecord<W>>& out)
+{
+    out.reserve(size_t(end - begin) / 12); // грубая оценка длины строки
+
+    for (const char* it = begin; it < end; )
+    {
+        std::string_view departure = token(it, end);
+        std::string_view target = token(it, end);
+        std::string_view weight = token(it, end);
+
+        W value = 0;
+        auto parsed = std::from_chars(weight.data(), weight.data() + weight.size(), value);
+        if (!departure.empty() && !target.empty() && !weight.empty() && parsed.ec == std::errc() && nonNegative(value))
+            out.push_back({departure, target, value}); // строки с ошибкой пропускаем
+
+        const char* newline = static_cast<const char*>(memchr(it, '\n', size_t(end - it)));
+        it = newline ? newline + 1 : end;
+    }
+}
+
+template class BasicEdgeList<uint32_t>;
+template class BasicEdgeList<uint64_t>;
+template class BasicEdgeList<float>;
+template class BasicEdgeList<double>;
@@ -1,20 +1,89 @@
 #include "../headers/node.h"
 
-void Node::removeNeighbour(Node* neighbour)
+#include <algorithm>
+
+namespace
+{
+    template <class W>
+    bool byNeighbourId(const std::pair<NodeId, W>& edge, NodeId id) { return edge.first < id; }
+}
+
+template <class W>
+W combineWeights(W old_weight, W new_weight, DuplicatePolicy policy)
 {
-    for (auto it = neighbours.begin(); it != neighbours.end(); ++it)
+    switch (policy)
+    {
+    case DuplicatePolicy::KeepMin: return std::min(old_weight, new_weight);
+    case DuplicatePolicy::KeepMax: return std::max(old_weight, new_weight);
+    case DuplicatePolicy::KeepLast: return new_weight;
+    case DuplicatePolicy::Sum:
+        // Целая сумма упирается в максимум типа вместо переполнения
+        if (std::is_integral_v<W> && new_weight > std::numeric_limits<W>::max() - old_weight)
+            return std::numeric_limits<W>::max();
+        return old_weight + new_weight;
+    }
+
+    return new_weight;
+}
+
+template <class W>
+void BasicNode<W>::merge(Edges& edges, std::vector<std::pair<NodeId, W>>& sorted, DuplicatePolicy policy)
+{
+    Edges merged(edges.get_allocator());
+    merged.reserve(edges.size() + sorted.size());
+
+    auto old_it = edges.begin();
+    auto new_it = sorted.begin();
+    while (old_it != edges.end() || new_it != sorted.end())
     {
-        if (it->first == neighbour)
+        if (new_it == sorted.end() || (old_it != edges.end() && old_it->first < new_it->first))
+            merged.push_back(*old_it++);
+        else if (old_it == edges.end() || new_it->first < old_it->first)
+            merged.push_back(*new_it++);
+        else
         {
-            neighbours.erase(it);
-            std::cout << "removed neighbour " << neighbour->getName() << " from node " << this->name << '\n' << std::endl;
-            return;
+            new_it->second = combineWeights(old_it->second, new_it->second, policy);
+            merged.push_back(*new_it++);
+            ++old_it;
         }
     }
+
+    edges.swap(merged);
+}
+
+template <class W>
+void BasicNode<W>::upsert(Edges& edges, NodeId other, W weight)
+{
+    // Порядок по id соседа не зависит от адресов в памяти, поэтому обход детерминирован
+    auto it = std::lower_bound(edges.begin(), edges.end(), other, byNeighbourId<W>);
+    if (it != edges.end() && it->first == other) it->second = weight;
+    else edges.insert(it, std::make_pair(other, weight));
+}
+
+template <class W>
+bool BasicNode<W>::erase(Edges& edges, NodeId other)
+{
+    auto it = std::lower_bound(edges.begin(), edges.end(), other, byNeighbourId<W>);
+    if (it == edges.end() || it->first != other)
+        return false;
+
+    edges.erase(it);
+    return true;
 }
 
-void Node::clearNeighbours()
+template <class W>
+W* BasicNode<W>::find(Edges& edges, NodeId other)
 {
-    neighbours.clear();
-    // std::cout << "neighbours of node " << this->name << " are cleared" << '\n' << std::endl;
+    auto it = std::lower_bound(edges.begin(), edges.end(), other, byNeighbourId<W>);
+    return it != edges.end() && it->first == other ? &it->second : nullptr;
 }
+
+template uint32_t combineWeights(uint32_t, uint32_t, DuplicatePolicy);
+template uint64_t combineWeights(uint64_t, uint64_t, DuplicatePolicy);
+template float combineWeights(float, float, DuplicatePolicy);
+template double combineWeights(double, double, DuplicatePolicy);
+
+template class BasicNode<uint32_t>;
+template class BasicNode<uint64_t>;
+template class BasicNode<float>;
+template class BasicNode<double>;
@@ -0,0 +1,75 @@
+#include "../headers/publisher.h"
+
+#include <stdexcept>
+
+SnapshotPublisher::SnapshotPublisher(CsrGraph initial, size_t max_readers)
+    : current(new CsrGraph(std::move(initial))), slots(std::make_unique<Slot[]>(max_readers)), slot_count(max_readers)
+{
+}
+
+SnapshotPublisher::~SnapshotPublisher()
+{
+    for (const Retired& old : retired) delete old.graph;
+    delete current.load();
+}
+
+SnapshotPublisher::Reader SnapshotPublisher::reader()
+{
+    for (size_t i = 0; i < slot_count; ++i)
+    {
+        bool expected = false;
+        if (slots[i].taken.compare_exchange_strong(expected, true))
+            return Reader(this, &slots[i]);
+    }
+
+    throw std::runtime_error("no free reader slots");
+}
+
+SnapshotPublisher::Pin SnapshotPublisher::Reader::pin()
+{
+    // Сначала объявляем эпоху, потом читаем указатель: писатель, снявший
+    // снимок после этого, увидит слот и не удалит его. Обе операции
+    // seq_cst - на этом порядке держится вся схема
+    slot->epoch.store(publisher->global_epoch.load());
+    return Pin(slot, publisher->current.load());
+}
+
+void SnapshotPublisher::publish(CsrGraph next)
+{
+    const CsrGraph* fresh = new CsrGraph(std::move(next));
+
+    std::lock_guard<std::mutex> lock(writer);
+    const CsrGraph* old = current.exchange(fresh);
+    retired.push_back({old, global_epoch.fetch_add(1)});
+    reclaimLocked();
+}
+
+void SnapshotPublisher::reclaim()
+{
+    std::lock_guard<std::mutex> lock(writer);
+    reclaimLocked();
+}
+
+void SnapshotPublisher::reclaimLocked()
+{
+    uint64_t oldest = std::numeric_limits<uint64_t>::max(); // самая ранняя эпоха среди закреплённых читателей
+    for (size_t i = 0; i < slot_count; ++i)
+    {
+        uint64_t epoch = slots[i].epoch.load();
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    size_t kept = 0;
+    for (const Retired& old : retired)
+    {
+        if (old.epoch < oldest) delete old.graph;
+        else retired[kept++] = old;
+    }
+    retired.resize(kept);
+}
+
+size_t SnapshotPublisher::pending() const
+{
+    std::lock_guard<std::mutex> lock(writer);
+    return retired.size();
+}
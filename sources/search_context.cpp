@@ -0,0 +1,25 @@
+#include "../headers/search_context.h"
+
+template <class D>
+void BasicSearchLabels<D>::reset(NodeId bound)
+{
+    if (stamps.size() < bound.index())
+    {
+        distances.resize(bound.index());
+        previous.resize(bound.index());
+        stamps.resize(bound.index(), 0);
+        marks.resize(bound.index(), 0);
+    }
+
+    // Поколение 0 означает "не записано"; при переполнении счётчика
+    // метки стираются честно, раз в 2^32 запросов
+    if (++generation == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        std::fill(marks.begin(), marks.end(), 0);
+        generation = 1;
+    }
+}
+
+template class BasicSearchLabels<uint64_t>;
+template class BasicSearchLabels<double>;
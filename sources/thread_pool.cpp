@@ -0,0 +1,59 @@
+#include "../headers/thread_pool.h"
+
+ThreadPool::ThreadPool(size_t threads) : active(0), stopping(false)
+{
+    if (threads == 0) threads = 1; // hardware_concurrency() может вернуть 0
+
+    for (size_t i = 0; i < threads; ++i) workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+
+    for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    available.notify_one();
+}
+
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return tasks.empty() && active == 0; });
+}
+
+void ThreadPool::work()
+{
+    for (;;)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) return; // stopping и работы не осталось
+
+            task = std::move(tasks.front());
+            tasks.pop();
+            ++active;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --active;
+        }
+        finished.notify_all();
+    }
+}
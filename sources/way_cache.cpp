@@ -0,0 +1,107 @@
+#include "../headers/way_cache.h"
+
+#include <functional>
+
+WayCache::WayCache(const Graph& agraph, size_t capacity, size_t ashard_count)
+    : graph(agraph), shard_count(ashard_count == 0 ? 1 : ashard_count)
+{
+    shards = std::make_unique<Shard[]>(shard_count);
+    shard_capacity = (capacity + shard_count - 1) / shard_count;
+    if (shard_capacity == 0) shard_capacity = 1;
+}
+
+std::string WayCache::makeKey(const std::string& departure, const std::string& target)
+{
+    // '\0' не встречается в именах из файла, поэтому ключ однозначен
+    std::string key;
+    key.reserve(departure.size() + target.size() + 1);
+    key.append(departure).push_back('\0');
+    key.append(target);
+
+    return key;
+}
+
+WayCache::Shard& WayCache::shardFor(const std::string& key) const
+{
+    return shards[std::hash<std::string>()(key) % shard_count];
+}
+
+bool WayCache::find(const std::string& departure, const std::string& target, Way& way)
+{
+    std::string key = makeKey(departure, target);
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.entries.find(key);
+    if (found == shard.entries.end())
+    {
+        ++shard.stats.misses;
+        return false;
+    }
+
+    if (found->second->version != graph.getVersion())
+    {
+        shard.order.erase(found->second);
+        shard.entries.erase(found);
+        ++shard.stats.invalidations;
+        ++shard.stats.misses;
+        return false;
+    }
+
+    shard.order.splice(shard.order.begin(), shard.order, found->second);
+    way = found->second->way;
+    ++shard.stats.hits;
+
+    return true;
+}
+
+void WayCache::store(const std::string& departure, const std::string& target, const Way& way, uint64_t version)
+{
+    std::string key = makeKey(departure, target);
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto found = shard.entries.find(key);
+    if (found != shard.entries.end())
+    {
+        found->second->version = version;
+        found->second->way = way;
+        shard.order.splice(shard.order.begin(), shard.order, found->second);
+        return;
+    }
+
+    if (shard.entries.size() >= shard_capacity)
+    {
+        shard.entries.erase(shard.order.back().key);
+        shard.order.pop_back();
+        ++shard.stats.evictions;
+    }
+
+    shard.order.push_front({std::move(key), version, way});
+    shard.entries.emplace(shard.order.front().key, shard.order.begin());
+}
+
+CacheStats WayCache::stats() const
+{
+    CacheStats total{};
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        total.hits += shards[i].stats.hits;
+        total.misses += shards[i].stats.misses;
+        total.evictions += shards[i].stats.evictions;
+        total.invalidations += shards[i].stats.invalidations;
+    }
+
+    return total;
+}
+
+void WayCache::clear()
+{
+    for (size_t i = 0; i < shard_count; ++i)
+    {
+        std::lock_guard<std::mutex> lock(shards[i].mutex);
+        shards[i].order.clear();
+        shards[i].entries.clear();
+    }
+}